@@ -0,0 +1,49 @@
+#pragma once
+
+#include "board.hpp"
+#include "game_state.hpp"
+#include "placement.hpp"
+#include "transposition.hpp"
+#include "tetromino.hpp"
+#include <span>
+
+// Linear evaluation of a board after a placement; higher is better. The defaults are the
+// well-known weights tuned by genetic search for this four-feature model.
+struct Heuristic {
+    double height = -0.510066; // sum of column heights
+    double lines = 0.760666; // lines cleared by the placement
+    double holes = -0.35663; // empty cells with a filled cell somewhere above
+    double bumpiness = -0.184483; // sum of height differences between neighbouring columns
+
+    double evaluate(const Board &board, int linesCleared) const;
+};
+
+// Input source that plays by itself: whenever a new piece spawns it searches every reachable placement
+// of the current piece (and, with lookahead, of the next piece on each resulting board) and returns
+// the moves that reach the best one right away, while the piece is still at the top.
+// The hard drop follows on the next tick, so the player places one piece per tick, and because
+// the next piece is planned as soon as the drop spawns it, no gravity step comes in between even at 20G.
+//
+// Call update() after every tick and apply the returned keys until it returns an empty span.
+class AutoPlayer {
+public:
+    // cache (optional, may be shared between threads) memoizes the best follow-up of a board for the next piece
+    explicit AutoPlayer(const Heuristic &heuristic = {}, bool lookahead = true, TranspositionCache *cache = nullptr): heuristic(heuristic), lookahead(lookahead), cache(cache) {}
+
+    std::span<const int> update(const GameState &state);
+
+private:
+    Heuristic heuristic;
+    bool lookahead;
+    TranspositionCache *cache;
+    int plannedPiece = -1; // GameState::getPiecesSpawned() of the piece the current plan is for
+    int plannedTick = -1;
+    bool dropPending = false;
+
+    PlacementFinder currentFinder;
+    PlacementFinder nextFinder;
+    int keys[PlacementFinder::MAX_STATES + 1];
+
+    int plan(const GameState &state); // fills keys with the moves for the current piece, returns their count
+    double bestFollowUp(const Board &board, const Tetromino &piece); // best evaluation over the placements of piece
+};
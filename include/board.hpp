@@ -1,23 +1,69 @@
 #pragma once
 
 #include "tetromino.hpp"
-#include <string>
+#include "renderer.hpp"
+#include "zobrist.hpp"
+#include <bit>
+#include <cstdint>
+#include <string_view>
 
 constexpr int BOARD_WIDTH = 10;
 constexpr int BOARD_HEIGHT = 20;
 
+// Bitboard layout: every row is one 16-bit word. Column x lives in bit (x + BOARD_WALL_BITS);
+// the unused bits on both sides are permanently set and act as walls, so a piece placed at
+// x in [-BOARD_WALL_BITS, BOARD_WIDTH) can be tested with a single shift and AND per row.
+constexpr int BOARD_WALL_BITS = 3;
+constexpr uint16_t BOARD_FULL_ROW = 0xFFFF;
+constexpr uint16_t BOARD_CELLS_MASK = ((1u << BOARD_WIDTH) - 1) << BOARD_WALL_BITS;
+constexpr uint16_t BOARD_EMPTY_ROW = BOARD_FULL_ROW & ~BOARD_CELLS_MASK;
+
+// Columns are kept as a second view of the same cells: bit y of a column word is row y, and the
+// bit below the last row is always set so every column has a floor to land on.
+constexpr uint32_t BOARD_FLOOR_BIT = 1u << BOARD_HEIGHT;
+
+constexpr uint16_t boardColumnBit(int x) { return static_cast<uint16_t>(1u << (x + BOARD_WALL_BITS)); }
+
+static_assert(BOARD_HEIGHT == zobrist_detail::ROWS && BOARD_WIDTH == zobrist_detail::CHUNKS * zobrist_detail::CHUNK_BITS, "Zobrist tables must cover the board");
+
+// Zobrist contribution of row y holding `row` (wall bits ignored).
+constexpr uint64_t boardRowHash(int y, uint16_t row) {
+    return zobristRow(y, static_cast<uint16_t>((row & BOARD_CELLS_MASK) >> BOARD_WALL_BITS));
+}
+
 class Board {
 public:
-    int grid[BOARD_HEIGHT][BOARD_WIDTH] = {};
+    uint16_t rows[BOARD_HEIGHT]; // locked cells (plus wall bits); modify through the methods so the hash stays in sync
+
+    Board();
 
-    Board() = default;
+    void draw(Renderer &r, const Tetromino &piece, int score, int level, int highscore, std::string_view note = {}) const; // optional right-side note (e.g. warnings) is drawn to the right of the first board rows
 
-    void draw(int score, int level, int highscore, const std::string &note = "") const; // optional right-side note (e.g. warnings) will be printed to the right of the board header
+    bool isOccupied(int x, int y) const { return (rows[y] & boardColumnBit(x)) != 0; }
+    int columnHeight(int x) const { return BOARD_HEIGHT - std::countr_zero(columns[x]); } // 0 for an empty column
+    int columnHoles(int x) const { return columnHeight(x) + 1 - std::popcount(columns[x]); } // empty cells below the column's top cell
 
-    void drawPiece(const Tetromino &t);
-    void clearPiece();
+    uint64_t getHash() const { return hash; } // Zobrist hash of the locked cells, kept up to date by every change
+    uint64_t computeHash() const; // the same hash rebuilt from scratch
+    void loadRows(const uint16_t (&source)[BOARD_HEIGHT]); // replaces every row (wall bits included) and rehashes
 
     bool collides(const Tetromino &t) const;
+    int dropDistance(const Tetromino &t) const; // rows a piece that does not collide can fall before it lands
     void lockPiece(const Tetromino &t);
-    int clearLines();
+    int clearLines(uint32_t *clearedRows = nullptr); // optional bit y set for every removed row (indices before the clear)
+
+    bool fillBottomHole(); // fills the first empty cell scanning from the bottom row upward
+    int deleteTopRows(int n); // removes up to n occupied rows from the top, returns how many were removed
+
+private:
+    uint64_t hash = 0; // the empty board hashes to 0
+    uint32_t dirtyRows = 0; // rows filled since the last clear; every other row is known not to be full
+    uint32_t columns[BOARD_WIDTH]; // bit y set for every locked cell of the column, plus BOARD_FLOOR_BIT
+
+    void rebuildColumns();
+
+    void removeRows(uint32_t mask); // one compaction pass: drops the rows in mask, the rest fall down in order
 };
+
+// Rotates clockwise trying each kick offset of the piece's table in order; leaves t untouched and returns false if all collide.
+bool rotateWithKicks(const Board &board, Tetromino &t);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "board.hpp"
+#include "tetromino.hpp"
+#include <cstdint>
+
+// LANES boards in structure-of-arrays layout: rows[y] holds row y of every board next to each
+// other, so one 256-bit register (or two 128-bit ones) covers a row of all lanes. The kernels
+// advance all lanes at once and match Board::collides, Board::lockPiece and Board::clearLines bit
+// for bit. They are compiled for AVX2 when the compiler targets it (-DTETRIS_AVX2=ON), SSE2 on any
+// other x86-64 build and plain loops elsewhere.
+//
+// Pieces at a different position in every lane cost a scatter per call, so for stepping games in
+// lockstep each lane's falling piece can also live in the batch as a layer of cells (active):
+// moving all pieces down or sideways is then the same handful of row-wide operations as a collide.
+class BoardBatch {
+public:
+    static constexpr int LANES = 16;
+    static constexpr uint32_t ALL_LANES = (1u << LANES) - 1;
+
+    alignas(32) uint16_t rows[BOARD_HEIGHT][LANES];
+    alignas(32) uint16_t active[BOARD_HEIGHT][LANES]; // cells of each lane's falling piece, 0 when it has none
+
+    BoardBatch(); // every lane starts empty
+
+    void setLane(int lane, const Board &board);
+    Board getLane(int lane) const;
+    void clearLane(int lane);
+
+    // pieces has one entry per lane; lanes outside the mask are ignored (and never reported)
+    uint32_t collides(const Tetromino *pieces, uint32_t lanes = ALL_LANES) const; // bit i set when lane i collides
+    void lockPieces(const Tetromino *pieces, uint32_t lanes = ALL_LANES);
+    uint32_t clearLines(uint8_t *cleared = nullptr); // optional per-lane counts; returns the lanes that cleared anything
+
+    // falling-piece layer; a spawned piece must lie inside the board rows (Board::collides would report it otherwise)
+    uint32_t spawnActive(const Tetromino *pieces, uint32_t lanes); // replaces the pieces of the lanes; returns those that collide
+    uint32_t shiftActive(uint32_t left, uint32_t right); // moves pieces one column where they fit; returns the lanes that moved
+    uint32_t dropActive(uint32_t lanes = ALL_LANES); // moves pieces one row down where they fit; returns the lanes that could not
+    void lockActive(uint32_t lanes); // locks the pieces of the lanes into their boards and empties the layer there
+
+    static const char *kernelName();
+};
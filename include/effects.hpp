@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+// Effects run on one of three clocks; each clock only moves forward.
+enum class EffectClock : uint8_t {
+    Tick, // simulation ticks (50 ms in real time)
+    Spawn, // pieces spawned, including skipped ones
+    Lock, // pieces locked
+};
+
+enum class EffectKind : uint8_t {
+    SpeedUp, // gravity multiplier of the active piece
+    Slow, // gravity divisor for the active piece and the next few
+    Cooldown, // a power-up that cannot be used yet
+    Notice, // a timed note shown next to the board
+};
+
+// Refers to one scheduled effect; it stops being pending once the effect expires, even if the
+// entry is reused for a later effect. The generation is wide enough that a handle kept for a whole
+// game never wraps around to match a later effect in the same entry.
+struct EffectHandle {
+    uint8_t index = 0xFF;
+    uint32_t generation = 0;
+};
+
+// Timing wheel of short-lived game effects. Every clock has SLOTS buckets and an effect due at
+// time t waits in bucket t % SLOTS, so advancing a clock by one step only looks at one bucket.
+// Effects further than SLOTS away stay in their bucket until the wheel comes round again.
+// Entries come from a fixed pool; nothing allocates.
+class EffectScheduler {
+public:
+    static constexpr int CAPACITY = 16;
+    static constexpr int SLOTS = 64; // power of two
+
+    struct Effect {
+        EffectKind kind;
+        int value;
+    };
+
+    EffectScheduler();
+
+    // Due times at or before the clock's current time expire on its next advance. Returns an
+    // invalid handle (never pending) if the pool is full.
+    EffectHandle schedule(EffectClock clock, uint64_t due, EffectKind kind, int value = 0);
+    bool reschedule(EffectHandle h, uint64_t due); // false if h is no longer pending
+    void cancel(EffectHandle h);
+
+    bool pending(EffectHandle h) const { return h.index < CAPACITY && entries[h.index].live && entries[h.index].generation == h.generation; }
+    uint64_t dueOf(EffectHandle h) const { return entries[h.index].due; } // h must be pending
+
+    // Moves the clock to now and calls onExpire(const Effect &) for every effect due by then.
+    template <typename F>
+    void advance(EffectClock clock, uint64_t now, F &&onExpire);
+
+private:
+    static constexpr uint8_t NONE = 0xFF;
+
+    struct Entry {
+        uint64_t due = 0;
+        Effect effect{};
+        uint32_t generation = 0;
+        uint8_t next = NONE; // bucket list while live, free list otherwise
+        uint8_t slot = 0; // bucket the entry is linked into
+        EffectClock clock = EffectClock::Tick;
+        bool live = false;
+    };
+
+    static constexpr int CLOCKS = 3;
+
+    Entry entries[CAPACITY];
+    uint8_t buckets[CLOCKS][SLOTS];
+    uint64_t now[CLOCKS] = {};
+    uint8_t freeList = 0;
+
+    void link(uint8_t index);
+    void unlink(uint8_t index);
+    void release(uint8_t index);
+};
+
+template <typename F>
+void EffectScheduler::advance(EffectClock clock, uint64_t to, F &&onExpire) {
+    int c = static_cast<int>(clock);
+    uint64_t from = now[c];
+    if (to <= from) return;
+    now[c] = to;
+
+    // a jump of a full turn or more has to look at every bucket once
+    uint64_t steps = to - from < SLOTS ? to - from : SLOTS;
+
+    for (uint64_t t = from + 1; t <= from + steps; ++t) {
+        uint8_t i = buckets[c][t & (SLOTS - 1)];
+
+        while (i != NONE) {
+            uint8_t next = entries[i].next; // the callback may schedule into this bucket
+
+            if (entries[i].due <= to) {
+                Effect expired = entries[i].effect;
+                unlink(i);
+                release(i);
+                onExpire(static_cast<const Effect &>(expired));
+            }
+
+            i = next;
+        }
+    }
+}
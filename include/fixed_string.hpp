@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Fixed-capacity text buffer for per-frame strings (side notes, headers). Appends that do not
+// fit are truncated, so it never touches the heap.
+template <std::size_t Capacity>
+class FixedString {
+public:
+    void clear() { length = 0; }
+
+    FixedString &append(std::string_view s) {
+        std::size_t n = s.size();
+        if (n > Capacity - length) n = Capacity - length;
+
+        for (std::size_t i = 0; i < n; ++i) data[length + i] = s[i];
+        length += n;
+        return *this;
+    }
+
+    FixedString &push_back(char c) {
+        if (length < Capacity) data[length++] = c;
+        return *this;
+    }
+
+    std::string_view view() const { return std::string_view(data, length); }
+    bool empty() const { return length == 0; }
+    std::size_t size() const { return length; }
+
+private:
+    char data[Capacity] = {};
+    std::size_t length = 0;
+};
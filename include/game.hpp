@@ -1,64 +1,89 @@
 #pragma once
 
-#include "board.hpp"
-#include "tetromino.hpp"
+#include "game_state.hpp"
 #include "highscore.hpp"
+#include "renderer.hpp"
+#include "input.hpp"
+#include "autoplayer.hpp"
 #include "modes.hpp"
-#include <memory>
+#include "replay.hpp"
+#include "telemetry.hpp"
+#include "fixed_string.hpp"
+#include "spsc_queue.hpp"
+#include "triple_buffer.hpp"
+#include "wakeup.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+// Everything one frame shows, copied out of the GameState so the render thread never touches it.
+struct FrameSnapshot {
+    Board board;
+    Tetromino current{};
+    Tetromino next{};
+    int score = 0;
+    int level = 0;
+    int highscore = 0;
+    FixedString<160> note;
+    uint64_t seq = 0; // frames are numbered from 1 in publishing order
+    platform::Clock::time_point inputSince{}; // oldest key in this frame not shown by an earlier one (input latency)
+};
 
+struct InputEvent {
+    int key;
+    platform::Clock::time_point time; // when the input thread read it
+};
+
+// Interactive driver. The simulation runs on the calling thread on an exact 50 ms tick. Keys are
+// read on an input thread and handed over with their timestamps through an SPSC queue; frames are
+// published as snapshots into a triple buffer, and a render thread presents the newest one. A slow
+// terminal therefore only drops frames: it never delays input handling, gravity or locking.
 class Game {
 public:
-    Game();
-    void run();
+    explicit Game(uint64_t seed, Randomizer randomizer = Randomizer::Uniform);
+    void run(); // plays interactively, records the game to a new file in replays/ and appends its telemetry to telemetry.jsonl
+    void replay(ReplayReader &reader, int speed); // plays a recording back at speed x real time, rendering every frame
 
-    void setMode(std::shared_ptr<IMode> m) { mode = std::move(m); }
+    void setMode(Mode m) { state.setMode(std::move(m)); }
     HighscoreManager &getHighscoreManager() { return highscoreManager; }
-
-    void scheduleNextSpeedMultiplier(int m) { nextSpeedMultiplier = m; speedNotePending = (m > 1); }
-
-    int getScore() const { return score; }
-
-    // Fun-mode / mode effect helper APIs (minimal public surface)
-    void fillBottomHole();
-    void skipCurrentPiece();
-    void applySlowToActivePiece(int factor);
-    void deleteTopRows(int n);
+    void setInputConfig(const InputConfig &config) { autoRepeat.setConfig(config); }
+    void setAutoplay(bool enabled) { autoplay = enabled; } // the AutoPlayer plays instead of the keyboard
 
 private:
-    Board board;
-    Tetromino current;
-    Tetromino next;
-    bool gameOver;
-    int tick;
-
-    int score;
-    int level;
-    int totalLinesCleared; // cumulative lines cleared
-    int ticksPerDrop; // controls how often pieces auto-drop (in ticks)
-
-    static constexpr int baseTicksPerDrop = 10;
-    static constexpr int linesPerLevel = 10;
-
+    GameState state;
     HighscoreManager highscoreManager;
-    std::shared_ptr<IMode> mode;
-
-    int nextSpeedMultiplier = 1; // multiplier to apply to next piece (default 1)
-    int activeSpeedMultiplier = 1; // multiplier currently in effect for the active piece
-
-    // note flags: pending means scheduled for next piece; active means the current piece is affected
-    bool speedNotePending = false;
-    bool speedNoteActive = false;
-
-    // slow effect state: how many upcoming pieces should be slowed, and whether current piece is slowed
-    int slowPiecesRemaining = 0; // number of upcoming pieces that will be slowed
-    bool slowActiveForCurrent = false; // whether the currently active piece is slowed
-    int slowFactorActive = 1; // multiplier for slowing
-
-    void drawNextPiece() const;
-    void hardDrop();
-    void onLinesCleared(int cleared);
-
-    void activateSlowForSpawnedPiece(); // helper to activate slow effect for newly spawned piece
-
-    friend class IMode; // allow modes to call game.* helpers if needed
+    int highscore = 0; // best score of the mode being played, shown in the header
+    Renderer renderer; // owned by the render thread while one runs
+    AutoRepeat autoRepeat;
+    ReplayWriter recorder;
+    AutoPlayer autoPlayer;
+    bool autoplay = false;
+    SessionTelemetry telemetry;
+
+    TripleBuffer<FrameSnapshot> frames;
+    Wakeup frameReady; // rung for every published frame and for repaints
+    std::atomic<bool> repaint{false}; // the terminal was resized: redraw everything
+    std::atomic<uint64_t> presentedSeq{0}; // newest frame the render thread has shown
+    uint64_t publishedSeq = 0;
+
+    SpscQueue<InputEvent, 256> inputs;
+    Wakeup inputReady;
+    platform::Clock::time_point inputSince{}; // oldest key not yet on screen
+    uint64_t inputSeq = 0; // first frame that contains it
+
+    std::atomic<bool> running{false}; // the input and render threads stop once this is cleared
+
+    static constexpr std::chrono::milliseconds tickDuration{50};
+    static constexpr std::chrono::milliseconds inputPollInterval{50}; // how soon the input thread notices the end of the game
+
+    bool applyInput(int key); // forwards to the state and records the key
+    void applyAutoRepeat(platform::Clock::time_point now);
+    void publishFrame(); // snapshots the state for the render thread and wakes it
+
+    void inputLoop(); // input thread: timestamps keys into `inputs`, turns resizes into repaints
+    void renderLoop(); // render thread: presents the newest frame until `running` is cleared
+
+    void drawNextPiece(const Tetromino &next);
+    void render(const FrameSnapshot &frame); // composes board, note and next piece and presents the frame
 };
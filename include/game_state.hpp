@@ -0,0 +1,133 @@
+#pragma once
+
+#include "board.hpp"
+#include "effects.hpp"
+#include "tetromino.hpp"
+#include "modes.hpp"
+#include "piece_queue.hpp"
+#include "random.hpp"
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// Things that happened since the driver last asked; the simulation itself never presents anything.
+struct GameEvents {
+    int piecesLocked = 0;
+    int linesCleared = 0;
+    uint32_t clearedRows = 0; // bit y set for every row removed by the most recent clear (indices before it)
+    bool speedWarning = false; // a mode sped up the piece that just spawned
+};
+
+// How often mode effects fired during the game (for balancing statistics).
+struct EffectCounts {
+    int holesFilled = 0;
+    int piecesSkipped = 0;
+    int slowsApplied = 0;
+    int rowDeletes = 0;
+    int speedUps = 0;
+};
+
+// Pure simulation of one game: no terminal I/O, no clocks and no sleeping. A driver feeds it the
+// keys that arrived during a tick with applyInput() and then calls advanceTick() once per 50 ms
+// (or as fast as it likes for headless runs); step() does both. Everything random derives from
+// the seed, so the same seed, mode and inputs replay the same game.
+class GameState {
+public:
+    explicit GameState(uint64_t seed = 0, Randomizer randomizer = Randomizer::Uniform);
+
+    void setMode(Mode m) { mode = std::move(m); } // before start(); a new state plays NormalMode
+    const Mode &getMode() const { return mode; }
+    void start(); // call once before the first tick: runs the mode's onStart hook
+
+    bool applyInput(int key); // returns true if a move/soft drop changed the piece position
+    void advanceTick(); // gravity, lock delay and the mode's onTick hook
+
+    GameEvents takeEvents(); // returns and resets the events gathered so far
+
+    const Board &getBoard() const { return board; }
+    const Tetromino &getCurrent() const { return current; }
+    const Tetromino &getNext() const { return next; }
+    uint8_t peekQueue(int i) const { return queue.peek(i); } // piece types after next, i < PieceQueue::LOOKAHEAD
+    uint64_t getSeed() const { return seed; }
+    Randomizer getRandomizer() const { return randomizer; }
+    bool isGameOver() const { return gameOver; }
+    int getTick() const { return tick; }
+    int getPiecesSpawned() const { return piecesSpawned; } // changes whenever a new active piece appears
+    int getScore() const { return score; }
+    int getLevel() const { return level; }
+    int getLinesCleared() const { return totalLinesCleared; }
+    int getPiecesLocked() const { return piecesLocked; }
+    int getClears(int lines) const { return clearsBySize[lines - 1]; } // clears of exactly 1-4 lines
+    std::string_view getSideNote() const; // speed notes take precedence over the mode's note
+    const EffectCounts &getEffectCounts() const { return effectCounts; }
+
+    Random &modeRandom() { return modeRng; } // separate stream for modes, so they never shift the piece sequence
+    EffectScheduler &getEffects() { return effects; } // modes may run their own timers (e.g. cooldowns) on the game's clocks
+    const EffectScheduler &getEffects() const { return effects; }
+    void scheduleNextSpeedMultiplier(int m); // from a lock hook: multiplies the gravity of the next piece until it locks
+
+    // Fun-mode / mode effect helper APIs (minimal public surface)
+    void fillBottomHole();
+    void skipCurrentPiece();
+    void applySlowToActivePiece(int factor);
+    void deleteTopRows(int n);
+
+    static constexpr int baseTicksPerDrop = 10; // level 0 falls one row every 10 ticks
+    static constexpr int gravityUnit = 1 << 16; // one row
+    static constexpr int maxGravity = BOARD_HEIGHT * gravityUnit; // 20G: a piece reaches the floor within one tick
+    static constexpr int lockDelayTicks = 10; // 500 ms on the floor before a piece locks
+    static constexpr int maxLockResets = 15; // moves/rotations on the floor that may restart the lock delay
+    static constexpr int linesPerLevel = 10;
+    static constexpr int slowPieces = 3; // a slow lasts for the active piece and the next two
+    static constexpr int noticeTicks = 16; // 800 ms
+
+    static int gravityForLevel(int level);
+
+private:
+    uint64_t seed;
+    Randomizer randomizer;
+    PieceQueue queue;
+    Random modeRng;
+
+    Board board;
+    Tetromino current;
+    Tetromino next;
+    bool gameOver;
+    int tick;
+    int piecesSpawned = 0;
+    int piecesLocked = 0;
+    int clearsBySize[4] = {}; // singles, doubles, triples, tetrises
+
+    int score;
+    int level;
+    int totalLinesCleared; // cumulative lines cleared
+    int gravity; // rows per tick in 1/gravityUnit fixed point, derived from the level
+    int gravityAccumulator = 0; // fractional rows carried over between ticks
+    int lockTicks = 0; // ticks the active piece has been resting on the stack
+    int lockResets = 0; // lock delay resets used by the active piece
+
+    Mode mode;
+    GameEvents events;
+    EffectCounts effectCounts;
+
+    // Effects set their factor when they start and the scheduler resets it when they expire.
+    EffectScheduler effects;
+    int speedMultiplier = 1; // gravity multiplier of the active piece
+    int slowFactor = 1; // gravity divisor of the active piece
+    EffectHandle speedUp; // expires when the sped-up piece locks
+    EffectHandle slow; // expires when the spawn count reaches the first piece no longer slowed
+    EffectHandle speedNotice; // timed note announcing a speed-up
+
+    void stepGravity();
+    void lockAndSpawn(); // locks the resting piece, applies mode effects and spawns the next one
+    void onPieceMoved(); // restarts the lock delay when a resting piece is moved or rotated
+    bool isResting() const;
+    int effectiveGravity() const;
+    void hardDrop();
+    void spawnNext(); // next becomes the active piece and the queue refills the preview
+    void onLinesCleared(int cleared);
+    void onEffectExpired(const EffectScheduler::Effect &effect);
+};
+
+// Advances one tick: applies the keys received during the tick in order, then gravity.
+void step(GameState &state, std::span<const int> inputs);
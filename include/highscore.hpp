@@ -1,16 +1,79 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
+struct LeaderboardEntry {
+    int32_t score = 0;
+    int32_t lines = 0;
+    int32_t level = 0;
+    int64_t date = 0; // seconds since the Unix epoch
+    uint64_t replayId = 0; // the game's replays/game-<id>.replay, 0 if none
+};
+
+// Top-N leaderboard per mode, kept in a small fixed-layout binary file that loads with one read.
+// submit() updates the in-memory board right away and hands the entry to a background writer.
+// Under an advisory lock on <path>.lock, the writer merges the entry into the file as it is now on
+// disk, so several game instances can share a working directory. It then replaces the file
+// atomically (temp file + rename). A file that does not decode is renamed to <path>.bad and rebuilt
+// from this instance's boards. If the lock cannot be taken or the file cannot be read, the save is
+// retried with backoff and finally skipped, but never done unlocked or over the unread file.
+// A legacy highscore.txt is migrated into the Normal board when no leaderboard file exists yet.
 class HighscoreManager {
 public:
-    explicit HighscoreManager(const std::string &path = "highscore.txt");
-    int getHighscore() const;
+    static constexpr int TOP_N = 10;
+    static constexpr int MAX_MODES = 8;
+    static constexpr int MAX_MODE_NAME = 15;
+
+    explicit HighscoreManager(const std::string &path = "leaderboard.bin", const std::string &legacyPath = "highscore.txt");
+    ~HighscoreManager(); // waits until queued entries are saved
+
     void load();
-    bool saveIfHigher(int score);
+    int getHighscore(std::string_view mode) const; // 0 if the mode has no entries yet
+    std::span<const LeaderboardEntry> getEntries(std::string_view mode) const; // best first
+
+    int submit(std::string_view mode, const LeaderboardEntry &entry); // rank from 0, or -1 if it did not make the board
+    void flush(); // blocks until every submitted entry is on disk
+
+    struct ModeBoard {
+        char name[MAX_MODE_NAME + 1] = {};
+        int count = 0;
+        LeaderboardEntry entries[TOP_N];
+    };
+
+    // all boards; fixed size, so loading never allocates
+    struct Table {
+        int modes = 0;
+        ModeBoard boards[MAX_MODES];
+    };
 
 private:
-    int highscore;
     std::string path;
-};
+    std::string legacyPath;
+    Table table;
+
+    // background writer
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::vector<std::pair<std::string, LeaderboardEntry>> pending;
+    Table latest; // copy of table when the last entry was queued; rebuilds a damaged file
+    bool writing = false;
+    bool stopping = false;
+    std::thread writer;
 
+    static constexpr int MAX_SAVE_ATTEMPTS = 5;
+    static constexpr std::chrono::milliseconds SAVE_RETRY_DELAY{ 100 }; // doubles with every failed attempt
+
+    void queueSave(std::string_view mode, const LeaderboardEntry &entry);
+    void writerLoop();
+    bool save(const std::vector<std::pair<std::string, LeaderboardEntry>> &batch, const Table &known); // false if nothing was written
+};
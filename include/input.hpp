@@ -0,0 +1,41 @@
+#pragma once
+
+#include "platform.hpp"
+#include <chrono>
+
+struct InputConfig {
+    std::chrono::milliseconds das{167}; // delayed auto-shift: how long a direction must be held before it repeats
+    std::chrono::milliseconds arr{33}; // auto-repeat rate for left/right; 0 slides straight to the wall
+    std::chrono::milliseconds softDropRate{33}; // repeat rate while 's' is held; 0 drops straight to the floor
+};
+
+// Terminals only report key presses plus the OS auto-repeat stream, never releases. Events of the same
+// key closer together than a human can tap are OS repeats: they mark the key as held and are absorbed,
+// and the key counts as released once they stop. While held, steps are generated on our own DAS/ARR
+// schedule (DAS measured from the original press), so movement speed depends neither on the keyboard
+// repeat settings nor on the frame rate.
+class AutoRepeat {
+public:
+    static constexpr int UNLIMITED = -1; // step count meaning "repeat until the move fails"
+
+    explicit AutoRepeat(const InputConfig &config = {});
+
+    void setConfig(const InputConfig &c) { config = c; }
+
+    bool onKey(int key, platform::Clock::time_point now); // true when the key must be applied now (fresh press or non-repeating key)
+    int due(platform::Clock::time_point now); // repeat steps of heldKey() that are due at now (may be UNLIMITED)
+    int heldKey() const { return held; }
+    platform::Clock::time_point nextDeadline() const; // when due() next has work; time_point::max() when idle
+
+private:
+    InputConfig config;
+
+    int held = 0; // 'a', 'd' or 's' while held, 0 otherwise
+    bool confirmed = false; // an OS repeat proved the key is physically held
+    platform::Clock::time_point pressTime{}; // first press of the current run of same-key events
+    platform::Clock::time_point lastEvent{};
+    platform::Clock::time_point nextRepeat{};
+    platform::Clock::duration releaseTimeout{};
+
+    std::chrono::milliseconds rateFor(int key) const { return key == 's' ? config.softDropRate : config.arr; }
+};
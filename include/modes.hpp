@@ -1,23 +1,95 @@
 #pragma once
 
-#include <memory>
-#include <string>
+#include "effects.hpp"
+#include "fixed_string.hpp"
+#include <optional>
+#include <string_view>
+#include <variant>
 
-class Game;
+class GameState;
 
-class IMode {
+// Tunables of the modes; the defaults are the shipped balance.
+struct FunModeConfig {
+    int pointsThreshold[4] = { 1000, 2500, 5000, 7500 }; // score that unlocks power-up 1-4
+    int cooldown[4] = { 15, 15, 15, 30 }; // locked pieces before a used power-up is ready again
+};
+
+struct HardModeConfig {
+    int minScore = 500; // no negative effects below this score
+    int chancePercent = 10; // chance per locked piece to speed up the next one
+    int speedMultiplier = 3;
+};
+
+// Modes are policies: plain types that define only the hooks they need, out of
+//   void onStart(GameState &), void onTick(GameState &, int tick), void onInput(GameState &, int key),
+//   void onLock(GameState &) and std::string_view getSideNote() const (valid until the next hook call).
+// GameState holds one of them in a Mode variant and calls a hook only where the policy defines it,
+// so a missing hook costs nothing and NormalMode adds no work at all.
+struct NormalMode {
+    static constexpr std::string_view NAME = "Normal";
+};
+
+class FunMode {
+public:
+    static constexpr std::string_view NAME = "Fun";
+
+    explicit FunMode(const FunModeConfig &config = {});
+
+    void onStart(GameState &game) { checkReadiness(game); } // determine initial readiness based on score
+    void onInput(GameState &game, int key) { if (key >= '1' && key <= '4') attemptActivate(game, key - '1'); }
+    void onLock(GameState &game);
+    std::string_view getSideNote() const { return note.view(); }
+
+private:
+    struct Powerup {
+        int pointsThreshold = 0; // points needed to unlock
+        int cooldownNeeded = 0; // number of fixed tetrominos needed to cooldown
+        EffectHandle cooldown; // pending on the game's lock clock while cooling down
+        bool ready = false;
+    };
+
+    Powerup p1, p2, p3, p4;
+    FixedString<160> note; // ready power-ups, rebuilt only when readiness changes
+
+    void rebuildNote();
+    void checkReadiness(const GameState &game);
+    void attemptActivate(GameState &game, int idx);
+    static EffectHandle startCooldown(GameState &game, const Powerup &p);
+};
+
+class HardMode {
+public:
+    static constexpr std::string_view NAME = "Hard";
+
+    explicit HardMode(const HardModeConfig &config = {}): config(config) {}
+
+    void onLock(GameState &game);
+
+private:
+    HardModeConfig config;
+};
+
+// Fun's power-ups and Hard's speed-ups together; each hook runs the Fun part first.
+class MixedMode {
 public:
-    virtual ~IMode() = default;
-    virtual void onStart(Game &game) {}
-    virtual void onTick(Game &game, int tick) {}
-    virtual void onInput(Game &game, int key) {}
-    virtual void onLock(Game &game) {}
-    virtual std::string name() const = 0;
-    virtual std::string getSideNote(const Game &game) const { return ""; }
+    static constexpr std::string_view NAME = "Mixed";
+
+    explicit MixedMode(const FunModeConfig &funConfig = {}, const HardModeConfig &hardConfig = {}): fun(funConfig), hard(hardConfig) {}
+
+    void onStart(GameState &game) { fun.onStart(game); }
+    void onInput(GameState &game, int key) { fun.onInput(game, key); }
+    void onLock(GameState &game) { fun.onLock(game); hard.onLock(game); }
+    std::string_view getSideNote() const { return fun.getSideNote(); }
+
+private:
+    FunMode fun;
+    HardMode hard;
 };
 
-std::shared_ptr<IMode> createNormalMode();
-std::shared_ptr<IMode> createFunMode();
-std::shared_ptr<IMode> createHardMode();
-std::shared_ptr<IMode> createMixedMode();
+using Mode = std::variant<NormalMode, FunMode, HardMode, MixedMode>;
+
+inline std::string_view modeName(const Mode &mode) {
+    return std::visit([](const auto &m) { return m.NAME; }, mode);
+}
 
+std::optional<Mode> modeByName(std::string_view name); // inverse of modeName(), with the default configs; nullopt if unknown
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "random.hpp"
+#include "tetromino.hpp"
+#include <cstdint>
+
+enum class Randomizer {
+    Uniform, // every piece drawn independently (the classic behaviour)
+    SevenBag // each batch of 7 is a shuffled permutation of all pieces
+};
+
+// Upcoming piece types in a ring buffer, generated a whole batch of 7 at a time. At least
+// LOOKAHEAD pieces are always buffered, so previews never trigger generation.
+class PieceQueue {
+public:
+    static constexpr int CAPACITY = 16; // power of two
+    static constexpr int BATCH = TETROMINO_TYPES;
+    static constexpr int LOOKAHEAD = CAPACITY - BATCH;
+
+    PieceQueue(uint64_t seed, Randomizer randomizer);
+
+    uint8_t pop(); // takes the next piece type
+    uint8_t peek(int i = 0) const { return types[(head + i) & (CAPACITY - 1)]; } // i < LOOKAHEAD
+
+private:
+    Random random;
+    Randomizer randomizer;
+    uint8_t types[CAPACITY];
+    int head = 0;
+    int count = 0;
+
+    void refill(); // appends one batch
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "board.hpp"
+#include "tetromino.hpp"
+#include <cstdint>
+#include <span>
+
+// A final resting position and the length of the shortest key sequence that locks the piece there.
+struct Placement {
+    Tetromino piece;
+    uint16_t inputs; // keys including the final hard drop
+    uint8_t rotation; // search state the hard drop starts from; used by PlacementFinder::path()
+    int8_t x;
+    int8_t y;
+};
+
+// Enumerates every resting position a piece can reach from where it is, using exactly the moves the
+// game accepts: 'a'/'d' shifts, 's' soft drops, 'w' rotations with the kick table, and ' ' to drop
+// and lock. That includes tucks and spins under overhangs. The search is a BFS over (rotation, y, x),
+// so each placement comes with a shortest input sequence. Positions that cover the same cells (for
+// example the O piece in any rotation) are reported once.
+//
+// The search is bit-parallel. fits[r][y] has bit x+3 set when the piece fits at (x, y), built once
+// per board with a few shifts per piece cell. The BFS then advances whole rows of states per layer:
+// shifts are bit shifts, soft drops AND with the next row, and kicks are tried for all columns at
+// once. Parents are not stored; path() walks the saved layers backwards. All storage lives in the
+// finder, so reuse one instance to search many boards without allocating.
+class PlacementFinder {
+public:
+    static constexpr int X_POSITIONS = BOARD_WIDTH + BOARD_WALL_BITS; // x in [-3, BOARD_WIDTH)
+    static constexpr int MAX_STATES = TETROMINO_ROTATIONS * BOARD_HEIGHT * 16;
+
+    // The piece must be inside the board (y >= 0); if it collides there is nothing to find.
+    // The returned span stays valid until the next call.
+    std::span<const Placement> find(const Board &board, const Tetromino &piece);
+
+    // Writes the keys that lead to p (ending with ' ') and returns how many; at most p.inputs.
+    int path(const Placement &p, int *keys) const;
+
+private:
+    // one board row of states that share a distance from the start
+    struct StateRow {
+        uint8_t rotation;
+        uint8_t y;
+        uint16_t xs; // bit x+3 per state
+    };
+
+    uint8_t type = 0;
+    uint16_t fits[TETROMINO_ROTATIONS][BOARD_HEIGHT + 1]; // the extra row stays 0: nothing fits below the floor
+    uint16_t reached[TETROMINO_ROTATIONS][BOARD_HEIGHT]; // states at a distance of at most the current layer
+    uint16_t pending[TETROMINO_ROTATIONS][BOARD_HEIGHT]; // states of the layer being built
+    uint32_t covered[TETROMINO_ROTATIONS][BOARD_HEIGHT + 8]; // footprints already reported, indexed by canonical position
+
+    StateRow layers[MAX_STATES]; // layer d is layers[layerStart[d] .. layerStart[d + 1])
+    uint16_t layerStart[MAX_STATES + 1];
+    uint16_t touched[MAX_STATES]; // rotation * BOARD_HEIGHT + y of the nonzero pending rows
+
+    Placement results[MAX_STATES];
+
+    bool inLayer(int d, int r, int y, int xb) const;
+    bool kickLands(int r, int y, int xb, int kick) const; // the kick is the first one of r that fits
+};
@@ -1,9 +1,33 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
 namespace platform {
+    using Clock = std::chrono::steady_clock;
+
+    // getch() reports arrow keys with these codes on every backend; they lie outside the byte range
+    constexpr int KEY_UP = 0x100;
+    constexpr int KEY_DOWN = 0x101;
+    constexpr int KEY_LEFT = 0x102;
+    constexpr int KEY_RIGHT = 0x103;
+
     void init();
     void restore();
     bool kbhit();
     int getch();
-}
+    bool waitForInput(Clock::time_point deadline); // true once a key is ready; false when the deadline passes or the terminal is resized
+    bool waitForInput(); // blocks until a key is ready (true) or the terminal is resized (false)
+    bool consumeResize(); // true once per terminal resize since the last call
+    void write(const char *data, size_t size); // unbuffered write of the whole range to the terminal
+
+    // Advisory exclusive lock shared by every process that locks the same path (the file is created
+    // if missing). Blocks until the lock is free; returns -1 on failure, otherwise a handle for unlockFile().
+    std::intptr_t lockFile(const char *path);
+    void unlockFile(std::intptr_t handle);
 
+    // Writes the data to path.tmp, flushes it to disk and renames it over path, so readers see either
+    // the old or the new file, never a partial one. Concurrent writers must hold a lockFile() lock.
+    bool writeFileAtomic(const char *path, const void *data, size_t size);
+}
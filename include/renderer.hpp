@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+constexpr int SCREEN_ROWS = 30;
+constexpr int SCREEN_COLS = 80;
+
+// Double-buffered terminal frame. Callers compose a frame into the back buffer every tick;
+// present() compares it against the last presented frame and writes only the cells that
+// changed (cursor move + glyph) in a single write call.
+class Renderer {
+public:
+    Renderer();
+
+    void clear(); // blank the back buffer before composing a new frame
+    void put(int row, int col, char32_t glyph);
+    int text(int row, int col, std::string_view utf8); // returns the number of columns written
+
+    bool present(); // returns false (and writes nothing) when the frame did not change
+    void invalidate(); // forget what is on screen; the next present() clears and redraws everything
+
+private:
+    char32_t front[SCREEN_ROWS][SCREEN_COLS];
+    char32_t back[SCREEN_ROWS][SCREEN_COLS];
+    bool clearPending = true;
+    int usedRows = 0; // rows below this were never drawn; the cursor is parked right after them
+
+    std::string out; // frame assembly buffer, reused between frames
+};
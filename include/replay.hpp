@@ -0,0 +1,76 @@
+#pragma once
+
+#include "game_state.hpp"
+#include "piece_queue.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Replay file layout (little endian):
+//   "ATRP" | version u8 | randomizer u8 | seed u64 | mode name length u8 | mode name bytes
+//   then one record per applied key: varint(tick - previous tick) varint(key + 1)
+//   and finally an end record: varint(final tick - previous tick) varint(0)
+// A file without the end record (e.g. the game was killed) still replays up to its last event.
+struct ReplayEvent {
+    int tick = 0;
+    int key = 0;
+};
+
+// Appends events to a replay file through a fixed buffer that is only written out when it fills up
+// and on finish(), so recording costs a few bytes of memcpy per key.
+class ReplayWriter {
+public:
+    ReplayWriter() = default;
+    ~ReplayWriter() { finish(lastTick); }
+
+    bool open(const std::string &path, uint64_t seed, Randomizer randomizer, std::string_view modeName);
+    bool isOpen() const { return out.is_open(); }
+
+    void record(int tick, int key);
+    void finish(int finalTick); // writes the end record and closes the file
+
+private:
+    std::ofstream out;
+    uint8_t buffer[4096];
+    size_t used = 0;
+    int lastTick = 0;
+
+    void putVarint(uint32_t value);
+    void flush();
+};
+
+// Loads a whole replay file and hands out its events in order.
+class ReplayReader {
+public:
+    bool open(const std::string &path); // false if the file is missing or not a replay
+
+    uint64_t getSeed() const { return seed; }
+    Randomizer getRandomizer() const { return randomizer; }
+    const std::string &getModeName() const { return modeName; }
+
+    bool hasEventAt(int tick) const { return !ended && pending.tick == tick; }
+    ReplayEvent take(); // returns the pending event and decodes the following one
+    bool finished(int tick) const { return ended && tick >= pending.tick; } // no events left and the recording ended by this tick
+
+private:
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+
+    uint64_t seed = 0;
+    Randomizer randomizer = Randomizer::Uniform;
+    std::string modeName;
+
+    ReplayEvent pending;
+    bool ended = false; // pending.tick is then the tick the recording stopped at
+
+    bool getVarint(uint32_t &value);
+    void decodeNext();
+};
+
+// Runs a replay to its end as fast as possible: no rendering, no clocks.
+void replayHeadless(GameState &state, ReplayReader &reader);
+
+uint64_t newReplayId(); // millisecond timestamp naming a new recording (leaderboard entries keep it)
+std::string replayPathFor(uint64_t id); // replays/game-<id>.replay; creates the replays/ directory if needed
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "game_state.hpp"
+#include "platform.hpp"
+#include <cstdint>
+#include <string>
+
+// Fixed-size histogram of durations in microseconds: exact below 64 µs, then 16 buckets per power of
+// two (about 6% wide). add() is a few integer operations and never allocates, so the game loop can
+// record every frame.
+class DurationHistogram {
+public:
+    void add(platform::Clock::duration d);
+
+    long long count() const { return total; }
+    long long percentile(double p) const; // µs; upper edge of the bucket holding the p-quantile (0 when empty)
+    long long max() const { return largest; }
+
+private:
+    static constexpr int LINEAR = 64;
+    static constexpr int SUB_BITS = 4;
+    static constexpr int OCTAVES = 26; // up to 2^32 µs, larger values land in the last bucket
+    static constexpr int BUCKETS = LINEAR + (OCTAVES << SUB_BITS);
+
+    uint32_t buckets[BUCKETS] = {};
+    long long total = 0;
+    long long largest = 0;
+
+    static int bucketOf(uint64_t us);
+    static uint64_t upperEdge(int bucket);
+};
+
+// Measurements the interactive loop gathers while a game runs.
+struct SessionTelemetry {
+    platform::Clock::time_point started{};
+    DurationHistogram frameTime; // work per loop iteration, from waking up to the presented frame
+    DurationHistogram inputLatency; // key read to the end of the frame that shows its effect
+    bool autoplay = false;
+};
+
+// Appends one JSON object per game (JSON lines) describing the session; returns false if the file cannot be written.
+bool appendTelemetry(const std::string &path, const GameState &state, const SessionTelemetry &session, platform::Clock::time_point ended);
@@ -1,11 +1,175 @@
 #pragma once
 
+#include <cstdint>
+
+constexpr int TETROMINO_TYPES = 7;
+constexpr int TETROMINO_ROTATIONS = 4;
+
+// A piece is just its type, orientation and position; the cells come from the tables below.
 struct Tetromino {
-    int shape[4][4];
-    int x;
-    int y;
+    uint8_t type;
+    uint8_t rotation;
+    int8_t x;
+    int8_t y;
+};
+
+// Row masks of one orientation: bit j of rows[i] set means cell (i, j) of the 4x4 box is occupied.
+struct PieceShape {
+    uint16_t rows[4];
+};
+
+// Lowest occupied row of each column of the 4x4 box, or -1 where the column is empty.
+struct PieceProfile {
+    int8_t bottom[4];
+};
+
+struct KickOffset {
+    int8_t dx;
+    int8_t dy;
 };
 
-Tetromino createRandomPiece();
+constexpr int KICK_TESTS = 7; // the first test is always the unmoved rotation
+
+namespace tetromino_detail {
+    constexpr int SHAPES[TETROMINO_TYPES][4][4] = {
+        // I
+        {
+            {0,0,0,0},
+            {1,1,1,1},
+            {0,0,0,0},
+            {0,0,0,0}
+        },
+        // O
+        {
+            {0,1,1,0},
+            {0,1,1,0},
+            {0,0,0,0},
+            {0,0,0,0}
+        },
+        // T
+        {
+            {0,1,0,0},
+            {1,1,1,0},
+            {0,0,0,0},
+            {0,0,0,0}
+        },
+        // S
+        {
+            {0,1,1,0},
+            {1,1,0,0},
+            {0,0,0,0},
+            {0,0,0,0}
+        },
+        // Z
+        {
+            {1,1,0,0},
+            {0,1,1,0},
+            {0,0,0,0},
+            {0,0,0,0}
+        },
+        // J
+        {
+            {1,0,0,0},
+            {1,1,1,0},
+            {0,0,0,0},
+            {0,0,0,0}
+        },
+        // L
+        {
+            {0,0,1,0},
+            {1,1,1,0},
+            {0,0,0,0},
+            {0,0,0,0}
+        }
+    };
+
+    struct ShapeTable {
+        PieceShape shapes[TETROMINO_TYPES][TETROMINO_ROTATIONS];
+    };
+
+    // Rotation works by transposing the matrix and then reversing each row: cell (i, j) moves to (j, 3 - i).
+    constexpr ShapeTable buildShapes() {
+        ShapeTable table{};
+
+        for (int type = 0; type < TETROMINO_TYPES; ++type) {
+            int cells[4][4] = {};
+
+            for (int i = 0; i < 4; ++i)
+                for (int j = 0; j < 4; ++j)
+                    cells[i][j] = SHAPES[type][i][j];
+
+            for (int rot = 0; rot < TETROMINO_ROTATIONS; ++rot) {
+                for (int i = 0; i < 4; ++i)
+                    for (int j = 0; j < 4; ++j)
+                        if (cells[i][j] == 1) table.shapes[type][rot].rows[i] |= static_cast<uint16_t>(1u << j);
+
+                int rotated[4][4] = {};
+                for (int i = 0; i < 4; ++i)
+                    for (int j = 0; j < 4; ++j)
+                        rotated[j][3 - i] = cells[i][j];
+
+                for (int i = 0; i < 4; ++i)
+                    for (int j = 0; j < 4; ++j)
+                        cells[i][j] = rotated[i][j];
+            }
+        }
+
+        return table;
+    }
+
+    struct ProfileTable {
+        PieceProfile profiles[TETROMINO_TYPES][TETROMINO_ROTATIONS];
+    };
+
+    constexpr ProfileTable buildProfiles(const ShapeTable &shapes) {
+        ProfileTable table{};
+
+        for (int type = 0; type < TETROMINO_TYPES; ++type) {
+            for (int rot = 0; rot < TETROMINO_ROTATIONS; ++rot) {
+                PieceProfile &profile = table.profiles[type][rot];
+
+                for (int j = 0; j < 4; ++j) {
+                    profile.bottom[j] = -1;
+                    for (int i = 0; i < 4; ++i)
+                        if (shapes.shapes[type][rot].rows[i] & (1u << j)) profile.bottom[j] = static_cast<int8_t>(i);
+                }
+            }
+        }
+
+        return table;
+    }
+
+    struct KickTable {
+        KickOffset kicks[TETROMINO_TYPES][TETROMINO_ROTATIONS][KICK_TESTS];
+    };
+
+    // Kicks are looked up per piece and per starting orientation (the target is always rotation + 1).
+    // Pieces rotate inside their 4x4 box rather than around an SRS pivot, so every entry uses the
+    // horizontal wall-kick sequence the game has always used; individual pairs can be tuned here.
+    constexpr KickTable buildKicks() {
+        constexpr KickOffset wallKicks[KICK_TESTS] = { {0, 0}, {-1, 0}, {1, 0}, {-2, 0}, {2, 0}, {-3, 0}, {3, 0} };
+
+        KickTable table{};
+
+        for (int type = 0; type < TETROMINO_TYPES; ++type)
+            for (int rot = 0; rot < TETROMINO_ROTATIONS; ++rot)
+                for (int k = 0; k < KICK_TESTS; ++k)
+                    table.kicks[type][rot][k] = wallKicks[k];
+
+        return table;
+    }
+}
+
+inline constexpr tetromino_detail::ShapeTable PIECE_SHAPES = tetromino_detail::buildShapes();
+inline constexpr tetromino_detail::ProfileTable PIECE_PROFILES = tetromino_detail::buildProfiles(PIECE_SHAPES);
+inline constexpr tetromino_detail::KickTable PIECE_KICKS = tetromino_detail::buildKicks();
+
+static_assert(sizeof(Tetromino) == 4, "a piece should fit in a single register");
+
+constexpr const PieceShape &shapeOf(const Tetromino &t) { return PIECE_SHAPES.shapes[t.type][t.rotation]; }
+constexpr const PieceProfile &profileOf(const Tetromino &t) { return PIECE_PROFILES.profiles[t.type][t.rotation]; }
+constexpr const KickOffset *kicksOf(const Tetromino &t) { return PIECE_KICKS.kicks[t.type][t.rotation]; }
+
+Tetromino createPiece(uint8_t type); // spawn orientation at the origin
 
-void rotateClockwise(Tetromino &t);
+constexpr void rotateClockwise(Tetromino &t) { t.rotation = static_cast<uint8_t>((t.rotation + 1) & 3); }
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for batches of independent jobs. Each worker owns a deque of job indices: it
+// takes work from the back of its own deque and, once that runs dry, steals from the front of the
+// others'. Jobs are dealt out in contiguous blocks up front, so as long as they take similar time
+// the workers never touch each other's deques and throughput scales with the number of cores.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency());
+    ~WorkStealingPool();
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Runs job(index, worker) for every index in [0, count) and returns once all of them finished.
+    void run(size_t count, const std::function<void(size_t, unsigned)> &job);
+
+private:
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex; // guards generation, stopping and the wait for completion
+    std::condition_variable wake;
+    std::condition_variable finished;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    const std::function<void(size_t, unsigned)> *job = nullptr;
+    std::atomic<size_t> remaining{0};
+
+    void workerLoop(unsigned id);
+    bool take(unsigned id, size_t &index);
+};
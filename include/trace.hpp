@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(TETRIS_TRACE)
+#include <atomic>
+#endif
+
+// Optional timeline of the game loop phases, exported in the Chrome trace-event format (open it in
+// chrome://tracing or ui.perfetto.dev). In builds configured with -DTETRIS_TRACE=ON, TRACE_SPAN("name")
+// times the rest of the enclosing scope into a preallocated ring buffer that keeps the newest
+// CAPACITY spans; recording costs a clock read at both ends and only happens after start().
+// Without the option the macro expands to nothing.
+namespace trace {
+#if defined(TETRIS_TRACE)
+    constexpr bool COMPILED_IN = true;
+#else
+    constexpr bool COMPILED_IN = false;
+#endif
+
+    constexpr uint32_t CAPACITY = 1u << 16; // spans kept, a power of two
+
+    void start(); // begin recording (no-op when compiled out)
+    bool writeChromeJson(const char *path); // false if compiled out or the file cannot be written
+
+#if defined(TETRIS_TRACE)
+    extern std::atomic<bool> recording; // read by every thread that opens a span
+
+    uint64_t now(); // ns on the steady clock
+    void record(const char *name, uint64_t begin, uint64_t end); // name must outlive the trace (a literal)
+
+    class Span {
+    public:
+        explicit Span(const char *n) : name(n), begin(recording.load(std::memory_order_relaxed) ? now() : 0) {}
+        ~Span() { if (begin) record(name, begin, now()); }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *name;
+        uint64_t begin;
+    };
+#endif
+}
+
+#if defined(TETRIS_TRACE)
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name) ::trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
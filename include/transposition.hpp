@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Fixed-size memo of evaluation results keyed by a 64-bit position hash (see zobristPosition()).
+// It is lock-free and may be shared by any number of threads: each slot stores the key XOR the
+// value next to the value, so a slot torn by concurrent writers simply fails the key check and
+// reads as a miss. Colliding keys overwrite each other; it is a cache, not a map.
+//
+// Results are only comparable if every user evaluates the same way, so share one cache only
+// between players with the same heuristic.
+class TranspositionCache {
+public:
+    explicit TranspositionCache(int log2Entries = 18);
+
+    bool probe(uint64_t key, double &value) const;
+    void store(uint64_t key, double value);
+
+    void clear();
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check{0}; // key ^ data
+        std::atomic<uint64_t> data{0};
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    uint64_t mask;
+};
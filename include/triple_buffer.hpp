@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-over of the latest value from one writer thread to one reader thread. Each side
+// owns one of three slots and the third is parked in between; publish() and take() swap their
+// slot with the parked one in a single atomic exchange, so neither side ever waits for the other.
+// A value published before the reader took the previous one replaces it: the reader always gets
+// the newest value and stale ones are dropped.
+template <typename T>
+class TripleBuffer {
+public:
+    T &back() { return slots[writeIndex]; } // the writer fills this in, then calls publish()
+
+    void publish() {
+        uint8_t old = parked.exchange(static_cast<uint8_t>(writeIndex | FRESH), std::memory_order_acq_rel);
+        writeIndex = old & INDEX; // may be the value the reader never took; it is overwritten next
+    }
+
+    // Moves the newest published value to front(); false (front() unchanged) if nothing new arrived.
+    bool take() {
+        if ((parked.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+
+        uint8_t old = parked.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = old & INDEX;
+        return true;
+    }
+
+    const T &front() const { return slots[readIndex]; }
+
+private:
+    static constexpr uint8_t INDEX = 3;
+    static constexpr uint8_t FRESH = 4; // the parked slot holds a value the reader has not seen
+
+    T slots[3]{};
+    alignas(64) std::atomic<uint8_t> parked{ 1 };
+    alignas(64) uint8_t writeIndex = 0; // touched by the writer only
+    alignas(64) uint8_t readIndex = 2; // touched by the reader only
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "platform.hpp"
+#include <condition_variable>
+#include <mutex>
+
+// Lets one thread sleep until another rings or a deadline passes. The data itself travels through
+// lock-free structures (SpscQueue, TripleBuffer); the mutex only guards the sleep, and a ring that
+// arrives while nobody waits is kept for the next wait.
+class Wakeup {
+public:
+    void ring() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            rung = true;
+        }
+        cv.notify_one();
+    }
+
+    bool waitUntil(platform::Clock::time_point deadline) { // true if rung before the deadline
+        std::unique_lock<std::mutex> lock(mutex);
+        bool woken = cv.wait_until(lock, deadline, [&] { return rung; });
+        rung = false;
+        return woken;
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return rung; });
+        rung = false;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool rung = false;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "tetromino.hpp"
+#include <cstdint>
+
+// Zobrist keys: every cell (and every piece type in each lookahead slot) gets a fixed random
+// 64-bit key, and a position hashes to the XOR of the keys of what it contains. Changing a cell
+// is then a single XOR, and equal boards always hash equally however they were reached.
+namespace zobrist_detail {
+    constexpr int ROWS = 20; // BOARD_HEIGHT; board.hpp includes this header
+    constexpr int CHUNK_BITS = 5; // a 10-cell row is looked up as two 5-bit chunks
+    constexpr int CHUNKS = 2;
+
+    constexpr uint64_t splitmix64(uint64_t &x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    struct KeyTable {
+        // rowKeys[y][c][bits]: XOR of the cell keys of the set bits of chunk c in row y
+        uint64_t rowKeys[ROWS][CHUNKS][1 << CHUNK_BITS];
+        uint64_t pieceKeys[2][TETROMINO_TYPES + 1]; // [current, next][type]; the last type means "none"
+    };
+
+    constexpr KeyTable buildKeys() {
+        KeyTable table{};
+        uint64_t seed = 0x5A0B1257;
+
+        for (int y = 0; y < ROWS; ++y) {
+            for (int c = 0; c < CHUNKS; ++c) {
+                uint64_t cellKeys[CHUNK_BITS] = {};
+                for (auto &key : cellKeys) key = splitmix64(seed);
+
+                for (int bits = 0; bits < (1 << CHUNK_BITS); ++bits)
+                    for (int j = 0; j < CHUNK_BITS; ++j)
+                        if (bits & (1 << j)) table.rowKeys[y][c][bits] ^= cellKeys[j];
+            }
+        }
+
+        for (auto &slot : table.pieceKeys)
+            for (auto &key : slot) key = splitmix64(seed);
+
+        return table;
+    }
+}
+
+inline constexpr zobrist_detail::KeyTable ZOBRIST_KEYS = zobrist_detail::buildKeys();
+
+constexpr int ZOBRIST_NO_PIECE = TETROMINO_TYPES;
+
+// Hash contribution of the cells in `cells` (bit x set for column x, BOARD_WIDTH bits) on row y.
+constexpr uint64_t zobristRow(int y, uint16_t cells) {
+    return ZOBRIST_KEYS.rowKeys[y][0][cells & 31] ^ ZOBRIST_KEYS.rowKeys[y][1][(cells >> 5) & 31];
+}
+
+// Combines a board hash with the active and upcoming piece types (ZOBRIST_NO_PIECE if unused).
+constexpr uint64_t zobristPosition(uint64_t boardHash, int current, int next) {
+    return boardHash ^ ZOBRIST_KEYS.pieceKeys[0][current] ^ ZOBRIST_KEYS.pieceKeys[1][next];
+}
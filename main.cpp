@@ -2,14 +2,121 @@
 #include "include/game.hpp"
 #include "include/menu.hpp"
 #include "include/modes.hpp"
+#include "include/replay.hpp"
+#include "include/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
-#include <ctime>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+static int playReplay(const char *path, int speed) {
+    ReplayReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "cannot read replay " << path << "\n";
+        return 1;
+    }
+
+    std::optional<Mode> mode = modeByName(reader.getModeName());
+    if (!mode) {
+        std::cerr << "unknown mode \"" << reader.getModeName() << "\" in replay\n";
+        return 1;
+    }
+
+    if (speed == 0) {
+        GameState state(reader.getSeed(), reader.getRandomizer());
+        state.setMode(*mode);
+
+        auto start = std::chrono::steady_clock::now();
+        replayHeadless(state, reader);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Score: " << state.getScore() << "  Lines: " << state.getLinesCleared() << "  Level: " << state.getLevel()
+                  << "  Ticks: " << state.getTick() << "  (" << elapsed.count() * 1000.0 << " ms)\n";
+        return 0;
+    }
+
+    platform::init();
+
+    Game game(reader.getSeed(), reader.getRandomizer());
+    game.setMode(*mode);
+    game.replay(reader, speed);
+
+    platform::restore();
+    return 0;
+}
+
+// writes the trace started before the game; returns the process exit code
+static int finishTrace(const char *path, int code) {
+    if (path && !trace::writeChromeJson(path)) {
+        std::cerr << "cannot write trace " << path << "\n";
+        return 1;
+    }
+
+    return code;
+}
+
+int main(int argc, char **argv) {
+    InputConfig input;
+    uint64_t seed = (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+    Randomizer randomizer = Randomizer::Uniform;
+    const char *replayPath = nullptr;
+    int replaySpeed = 1;
+    bool autoplay = false;
+    const char *tracePath = nullptr;
+
+    // optional tuning: --das <ms>, --arr <ms>, --sdr <ms> (0 for ARR/SDR means instant),
+    // --seed <n> to replay a piece sequence, --bag for the 7-bag randomizer,
+    // --replay <file> to watch a recorded game at --speed <n> x real time (0: as fast as possible, no rendering),
+    // --autoplay to let the built-in AI play the selected mode,
+    // --trace <file> to write a Chrome trace of the game loop (builds with -DTETRIS_TRACE=ON)
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bag") == 0) {
+            randomizer = Randomizer::SevenBag;
+            continue;
+        }
+
+        if (std::strcmp(argv[i], "--autoplay") == 0) {
+            autoplay = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << argv[i] << "\n";
+            return 1;
+        }
+
+        const char *value = argv[++i];
+        std::chrono::milliseconds ms(std::atoi(value));
+
+        if (std::strcmp(argv[i - 1], "--das") == 0) input.das = ms;
+        else if (std::strcmp(argv[i - 1], "--arr") == 0) input.arr = ms;
+        else if (std::strcmp(argv[i - 1], "--sdr") == 0) input.softDropRate = ms;
+        else if (std::strcmp(argv[i - 1], "--seed") == 0) seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(argv[i - 1], "--replay") == 0) replayPath = value;
+        else if (std::strcmp(argv[i - 1], "--speed") == 0) replaySpeed = std::max(std::atoi(value), 0);
+        else if (std::strcmp(argv[i - 1], "--trace") == 0) tracePath = value;
+        else {
+            std::cerr << "unknown option " << argv[i - 1] << "\n";
+            return 1;
+        }
+    }
+
+    if (tracePath && !trace::COMPILED_IN) {
+        std::cerr << "--trace needs a build configured with -DTETRIS_TRACE=ON\n";
+        return 1;
+    }
+
+    if (tracePath) trace::start();
+    if (replayPath) return finishTrace(tracePath, playReplay(replayPath, replaySpeed));
 
-int main() {
     platform::init();
-    srand(static_cast<unsigned>(time(nullptr)));
 
-    Game game;
+    Game game(seed, randomizer);
+    game.setInputConfig(input);
+    game.setAutoplay(autoplay);
 
     // show main menu
     Menu menu(game.getHighscoreManager());
@@ -18,21 +125,20 @@ int main() {
 
     if (selection == Menu::Selection::Quit) {
         platform::restore();
-        return 0;
+        return finishTrace(tracePath, 0);
     }
 
-    std::shared_ptr<IMode> mode;
+    Mode mode;
     switch (selection) {
-        case Menu::Selection::Normal: mode = createNormalMode(); break;
-        case Menu::Selection::Fun: mode = createFunMode(); break;
-        case Menu::Selection::Hard: mode = createHardMode(); break;
-        case Menu::Selection::Mixed: mode = createMixedMode(); break;
-        default: mode = createNormalMode(); break;
+        case Menu::Selection::Fun: mode = FunMode(); break;
+        case Menu::Selection::Hard: mode = HardMode(); break;
+        case Menu::Selection::Mixed: mode = MixedMode(); break;
+        default: mode = NormalMode(); break;
     }
 
     game.setMode(mode);
     game.run();
 
     platform::restore();
-    return 0;
+    return finishTrace(tracePath, 0);
 }
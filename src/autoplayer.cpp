@@ -0,0 +1,91 @@
+#include "../include/autoplayer.hpp"
+#include <limits>
+
+namespace {
+    int lockAndClear(Board &board, const Tetromino &piece) {
+        board.lockPiece(piece);
+        return board.clearLines();
+    }
+}
+
+double Heuristic::evaluate(const Board &board, int linesCleared) const {
+    int heights[BOARD_WIDTH];
+    int aggregate = 0, holeCount = 0, bumps = 0;
+
+    for (int x = 0; x < BOARD_WIDTH; ++x) {
+        heights[x] = board.columnHeight(x);
+        aggregate += heights[x];
+        holeCount += board.columnHoles(x);
+        if (x > 0) bumps += heights[x] > heights[x - 1] ? heights[x] - heights[x - 1] : heights[x - 1] - heights[x];
+    }
+
+    return height * aggregate + lines * linesCleared + holes * holeCount + bumpiness * bumps;
+}
+
+std::span<const int> AutoPlayer::update(const GameState &state) {
+    static constexpr int hardDrop[] = { ' ' };
+    if (state.isGameOver()) return {};
+
+    if (state.getPiecesSpawned() != plannedPiece) {
+        // a new piece (gravity locked the last one early, or our drop spawned it): plan its moves
+        plannedPiece = state.getPiecesSpawned();
+        plannedTick = state.getTick();
+        dropPending = true;
+        return std::span<const int>(keys, plan(state));
+    }
+
+    if (dropPending && state.getTick() != plannedTick) {
+        dropPending = false;
+        return hardDrop;
+    }
+
+    return {};
+}
+
+int AutoPlayer::plan(const GameState &state) {
+    std::span<const Placement> first = currentFinder.find(state.getBoard(), state.getCurrent());
+    if (first.empty()) return 0;
+
+    Tetromino nextSpawn = state.getNext();
+    nextSpawn.x = BOARD_WIDTH / 2 - 2;
+    nextSpawn.y = 0;
+
+    size_t best = 0;
+    double bestScore = -std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < first.size(); ++i) {
+        Board after = state.getBoard();
+        int cleared = lockAndClear(after, first[i].piece);
+        double score = heuristic.evaluate(after, cleared);
+
+        // rate the first placement by the best follow-up for the next piece; the evaluation is linear,
+        // so the lines of the first placement can be added afterwards and the follow-up memoized
+        if (lookahead) score = bestFollowUp(after, nextSpawn) + heuristic.lines * cleared;
+
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+
+    // everything but the hard drop, which update() sends on the next tick
+    return currentFinder.path(first[best], keys) - 1;
+}
+
+double AutoPlayer::bestFollowUp(const Board &board, const Tetromino &piece) {
+    uint64_t key = zobristPosition(board.getHash(), piece.type, ZOBRIST_NO_PIECE);
+    double best;
+    if (cache && cache->probe(key, best)) return best;
+
+    best = -std::numeric_limits<double>::infinity(); // no placement means game over
+
+    for (const Placement &p : nextFinder.find(board, piece)) {
+        Board after = board;
+        int cleared = lockAndClear(after, p.piece);
+        double s = heuristic.evaluate(after, cleared);
+        if (s > best) best = s;
+    }
+
+    if (cache) cache->store(key, best);
+    return best;
+}
@@ -1,142 +1,262 @@
 #include "../include/board.hpp"
-#include <iostream>
-#include <iomanip>
-#include <sstream>
-#include <vector>
+#include "../include/fixed_string.hpp"
+#include <bit>
+#include <charconv>
 
-void Board::draw(int score, int level, int highscore, const std::string &note) const {
-    std::cout << "\033[H"; // move cursor to home
-
-    std::ostringstream header;
-    header << "Score: " << score << "    Level: " << level << "    High: " << highscore;
-    std::string headerStr = header.str();
+namespace {
+    template <std::size_t N>
+    void appendNumber(FixedString<N> &out, int value) {
+        char digits[12];
+        auto res = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(std::string_view(digits, res.ptr - digits));
+    }
 
-    std::vector<std::string> noteLines;
+    // Shifts a 4-bit piece row into board bit positions; only valid for x in [-BOARD_WALL_BITS, BOARD_WIDTH).
+    inline uint16_t pieceRowBits(uint16_t mask, int x) {
+        return static_cast<uint16_t>(mask << (x + BOARD_WALL_BITS));
+    }
 
-    if (!note.empty()) {
-        std::istringstream ss(note);
-        std::string line;
-        while (std::getline(ss, line)) noteLines.push_back(line);
+    inline bool inHorizontalRange(int x) {
+        return x >= -BOARD_WALL_BITS && x < BOARD_WIDTH;
     }
+}
+
+void Board::draw(Renderer &r, const Tetromino &piece, int score, int level, int highscore, std::string_view note) const {
+    FixedString<64> header;
+    appendNumber(header.append("Score: "), score);
+    appendNumber(header.append("    Level: "), level);
+    appendNumber(header.append("    High: "), highscore);
 
     const int clearArea = 40; // reserve 40 chars for note area
     const int noteSlots = 4; // dedicate first 4 board rows to the 4 power-up notes
+    const int top = 2; // header and frame title come first
 
     // print header (no notes next to header)
-    std::cout << headerStr;
-    std::cout << "\n";
+    r.text(0, 0, header.view());
+    r.text(1, 0, "┌---- ASCII TETRIS ---┐");
+
+    const PieceShape &shape = shapeOf(piece);
 
-    std::cout << "┌---- ASCII TETRIS ---┐";
-    for (int i = 0; i < clearArea; ++i) std::cout << ' ';
-    std::cout << "\n";
+    // the ghost shows where a hard drop would land; a piece that already collides (game over) gets none
+    int ghostY = collides(piece) ? piece.y : piece.y + dropDistance(piece);
 
     for (int y = 0; y < BOARD_HEIGHT; y++) {
-        std::cout << "|";
+        int row = top + y;
+        int col = 0;
+
+        int pieceRow = y - piece.y;
+        uint16_t pieceBits = (pieceRow >= 0 && pieceRow < 4 && inHorizontalRange(piece.x)) ? pieceRowBits(shape.rows[pieceRow], piece.x) : 0;
+        int ghostRow = y - ghostY;
+        uint16_t ghostBits = (ghostRow >= 0 && ghostRow < 4 && inHorizontalRange(piece.x)) ? pieceRowBits(shape.rows[ghostRow], piece.x) : 0;
+
+        r.put(row, col++, U'|');
 
         for (int x = 0; x < BOARD_WIDTH; x++) {
-            if (grid[y][x] == 0) std::cout << " ."; // empty
-            else if (grid[y][x] == 1) std::cout << " #"; // locked piece
-            else std::cout << " @"; // current piece
+            uint16_t bit = boardColumnBit(x);
+            char32_t glyph = U'.'; // empty
+
+            if (pieceBits & bit) glyph = U'@'; // current piece
+            else if (rows[y] & bit) glyph = U'#'; // locked piece
+            else if (ghostBits & bit) glyph = U'+'; // landing spot of the current piece
+
+            r.put(row, col++, U' ');
+            r.put(row, col++, glyph);
         }
 
-        std::cout << " |";
+        col += r.text(row, col, " |");
+
+        // print the next note line next to the board row if available
+        if (y < noteSlots && !note.empty()) {
+            size_t end = note.find('\n');
+            std::string_view nl = note.substr(0, end);
+            note = (end == std::string_view::npos) ? std::string_view() : note.substr(end + 1);
 
-        // print note line next to the board row if available
-        if (y < noteSlots && y < (int)noteLines.size() && !noteLines[y].empty()) {
-            std::string nl = noteLines[y];
             // truncate if too long
-            if ((int)nl.size() > clearArea) nl = nl.substr(0, clearArea);
-            std::cout << "  " << nl;
-            int remaining = clearArea - (int)nl.size();
-            for (int i = 0; i < remaining; ++i) std::cout << ' ';
-        } else {
-            for (int i = 0; i < clearArea; ++i) std::cout << ' ';
+            if (!nl.empty()) r.text(row, col + 2, nl.substr(0, clearArea));
         }
-
-        std::cout << "\n";
     }
 
-    std::cout << "└---------------------┘";
+    r.text(top + BOARD_HEIGHT, 0, "└---------------------┘");
+}
+
+Board::Board() {
+    for (auto &row : rows) row = BOARD_EMPTY_ROW;
+    for (auto &column : columns) column = BOARD_FLOOR_BIT;
+}
 
-    std::cout << "\n";
-    std::cout.flush();
+void Board::rebuildColumns() {
+    for (int x = 0; x < BOARD_WIDTH; ++x) {
+        columns[x] = BOARD_FLOOR_BIT;
+        for (int y = 0; y < BOARD_HEIGHT; ++y)
+            if (isOccupied(x, y)) columns[x] |= 1u << y;
+    }
 }
 
-void Board::drawPiece(const Tetromino &t) {
+bool Board::collides(const Tetromino &t) const {
+    // every piece has at least one cell, so a box entirely outside the walls always collides
+    if (!inHorizontalRange(t.x)) return true;
+    const PieceShape &shape = shapeOf(t);
+
     for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            if (t.shape[i][j] == 1) {
-                int bx = t.x + j;
-                int by = t.y + i;
-
-                if (by >= 0 && by < BOARD_HEIGHT && bx >= 0 && bx < BOARD_WIDTH)
-                    grid[by][bx] = 2;
-            }
-        }
+        if (shape.rows[i] == 0) continue;
+
+        int by = t.y + i;
+        if (by < 0 || by >= BOARD_HEIGHT) return true;
+
+        if (rows[by] & pieceRowBits(shape.rows[i], t.x)) return true; // wall or locked cell
     }
+
+    return false;
 }
 
-void Board::clearPiece() {
-    for (auto &row : grid)
-        for (auto &cell : row)
-            if (cell == 2) cell = 0;
+// Each column of a tetromino is one contiguous run of cells, so the run slides down until its lowest
+// cell meets the first locked cell (or the floor) below it; the closest such column decides.
+int Board::dropDistance(const Tetromino &t) const {
+    const PieceProfile &profile = profileOf(t);
+    int distance = BOARD_HEIGHT;
+
+    for (int j = 0; j < 4; ++j) {
+        if (profile.bottom[j] < 0) continue;
+
+        int gap = std::countr_zero(columns[t.x + j] >> (t.y + profile.bottom[j] + 1));
+        if (gap < distance) distance = gap;
+    }
+
+    return distance;
 }
 
-bool Board::collides(const Tetromino &t) const {
+void Board::lockPiece(const Tetromino &t) {
+    if (!inHorizontalRange(t.x)) return;
+    const PieceShape &shape = shapeOf(t);
+
     for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            if (t.shape[i][j] == 1) {
-                int bx = t.x + j;
-                int by = t.y + i;
+        int by = t.y + i;
+
+        if (by >= 0 && by < BOARD_HEIGHT) {
+            uint16_t added = pieceRowBits(shape.rows[i], t.x) & static_cast<uint16_t>(~rows[by]);
+            hash ^= boardRowHash(by, added);
+            rows[by] |= added;
+            if (added) dirtyRows |= 1u << by;
 
-                // check bounds
-                if (bx < 0 || bx >= BOARD_WIDTH) return true;
-                if (by < 0 || by >= BOARD_HEIGHT) return true;
+            for (uint16_t cells = added; cells; cells &= cells - 1)
+                columns[std::countr_zero(cells) - BOARD_WALL_BITS] |= 1u << by;
+        }
+    }
+}
+
+// Bottom-up, each kept row moves straight to its final position, so a tetris moves every row at
+// most once: the rows between two removed ones all fall by the number of removed rows below them.
+// A row that moves swaps the old hash contribution at its destination for its own.
+void Board::removeRows(uint32_t mask) {
+    int shift = 0;
 
-                if (grid[by][bx] != 0) return true; // collision with locked piece
-            }
+    for (uint32_t remaining = mask; remaining;) {
+        int removed = 31 - std::countl_zero(remaining);
+        remaining &= ~(1u << removed);
+        ++shift;
+
+        int next = remaining ? 31 - std::countl_zero(remaining) : -1;
+        for (int src = removed - 1; src > next; --src) {
+            hash ^= boardRowHash(src + shift, rows[src + shift]) ^ boardRowHash(src + shift, rows[src]);
+            rows[src + shift] = rows[src];
         }
     }
 
-    return false;
+    for (int y = shift - 1; y >= 0; --y) {
+        hash ^= boardRowHash(y, rows[y]);
+        rows[y] = BOARD_EMPTY_ROW;
+    }
+
+    // same compaction on the column view, topmost removed row first so the lower indices stay valid
+    for (uint32_t remaining = mask; remaining; remaining &= remaining - 1) {
+        uint32_t above = (1u << std::countr_zero(remaining)) - 1;
+
+        for (auto &column : columns)
+            column = ((column & above) << 1) | (column & ~(above << 1 | 1u));
+    }
 }
 
-void Board::lockPiece(const Tetromino &t) {
-    for (int i = 0; i < 4; ++i)
-        for (int j = 0; j < 4; ++j)
-            if (t.shape[i][j] == 1) {
-                int bx = t.x + j;
-                int by = t.y + i;
-
-                if (by >= 0 && by < BOARD_HEIGHT && bx >= 0 && bx < BOARD_WIDTH)
-                    grid[by][bx] = 1;
-            }
+uint64_t Board::computeHash() const {
+    uint64_t h = 0;
+    for (int y = 0; y < BOARD_HEIGHT; ++y) h ^= boardRowHash(y, rows[y]);
+    return h;
+}
+
+void Board::loadRows(const uint16_t (&source)[BOARD_HEIGHT]) {
+    for (int y = 0; y < BOARD_HEIGHT; ++y) rows[y] = source[y];
+    hash = computeHash();
+    dirtyRows = (1u << BOARD_HEIGHT) - 1;
+    rebuildColumns();
 }
 
-int Board::clearLines() {
-    int cleared = 0;
+// only rows filled since the last clear can have become full (at most the four a piece touched)
+int Board::clearLines(uint32_t *clearedRows) {
+    uint32_t full = 0;
+
+    for (uint32_t dirty = dirtyRows; dirty; dirty &= dirty - 1) {
+        int y = std::countr_zero(dirty);
+        if (rows[y] == BOARD_FULL_ROW) full |= 1u << y;
+    }
 
-    for (int y = 0; y < BOARD_HEIGHT; ++y) {
-        bool full = true;
+    dirtyRows = 0;
+    if (full) removeRows(full);
 
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            if (grid[y][x] == 0) {
-                full = false;
-                break;
-            }
+    if (clearedRows) *clearedRows = full;
+    return std::popcount(full);
+}
+
+bool rotateWithKicks(const Board &board, Tetromino &t) {
+    Tetromino rot = t;
+    rotateClockwise(rot);
+
+    const KickOffset *kicks = kicksOf(t);
+
+    for (int k = 0; k < KICK_TESTS; ++k) {
+        Tetromino kicked = rot;
+        kicked.x = static_cast<int8_t>(rot.x + kicks[k].dx);
+        kicked.y = static_cast<int8_t>(rot.y + kicks[k].dy);
+
+        if (!board.collides(kicked)) {
+            t = kicked;
+            return true;
         }
+    }
 
-        if (full) {
-            ++cleared;
+    return false;
+}
 
-            for (int ty = y; ty > 0; --ty)
-                for (int tx = 0; tx < BOARD_WIDTH; ++tx)
-                    grid[ty][tx] = grid[ty - 1][tx];
+bool Board::fillBottomHole() {
+    for (int y = BOARD_HEIGHT - 1; y >= 0; --y) {
+        uint16_t free = static_cast<uint16_t>(~rows[y]);
 
-            for (int tx = 0; tx < BOARD_WIDTH; ++tx)
-                grid[0][tx] = 0;
+        if (free) {
+            uint16_t cell = free & static_cast<uint16_t>(-free); // lowest free bit is the leftmost empty column
+            hash ^= boardRowHash(y, cell);
+            rows[y] |= cell;
+            dirtyRows |= 1u << y;
+            columns[std::countr_zero(cell) - BOARD_WALL_BITS] |= 1u << y;
+            return true;
         }
     }
 
-    return cleared;
+    return false;
+}
+
+int Board::deleteTopRows(int n) {
+    uint32_t mask = 0;
+    int removed = 0;
+
+    for (int y = 0; y < BOARD_HEIGHT && removed < n; ++y) {
+        if (rows[y] != BOARD_EMPTY_ROW) {
+            mask |= 1u << y;
+            ++removed;
+        }
+    }
+
+    if (!mask) return 0;
+    removeRows(mask);
+
+    // rows below the deleted ones moved, so pending full-row checks can no longer be tracked by index
+    if (dirtyRows) dirtyRows = (1u << BOARD_HEIGHT) - 1;
+    return removed;
 }
@@ -0,0 +1,312 @@
+#include "../include/board_batch.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BATCH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BATCH_SSE2 1
+#endif
+
+namespace {
+    // One row of all lanes. The three implementations expose the same handful of operations.
+#if defined(BATCH_AVX2)
+    struct Row {
+        __m256i v;
+    };
+
+    inline Row load(const uint16_t *p) { return { _mm256_load_si256(reinterpret_cast<const __m256i *>(p)) }; }
+    inline void store(uint16_t *p, Row r) { _mm256_store_si256(reinterpret_cast<__m256i *>(p), r.v); }
+    inline Row splat(uint16_t x) { return { _mm256_set1_epi16(static_cast<short>(x)) }; }
+    inline Row operator&(Row a, Row b) { return { _mm256_and_si256(a.v, b.v) }; }
+    inline Row operator|(Row a, Row b) { return { _mm256_or_si256(a.v, b.v) }; }
+    inline Row operator-(Row a, Row b) { return { _mm256_sub_epi16(a.v, b.v) }; }
+    inline Row equal(Row a, Row b) { return { _mm256_cmpeq_epi16(a.v, b.v) }; }
+    inline Row select(Row mask, Row a, Row b) { return { _mm256_blendv_epi8(b.v, a.v, mask.v) }; } // mask ? a : b
+    inline Row shiftLeft(Row a) { return { _mm256_slli_epi16(a.v, 1) }; }
+    inline Row shiftRight(Row a) { return { _mm256_srli_epi16(a.v, 1) }; }
+
+    // bit i set when lane i of a mask row is all ones
+    inline uint32_t laneBits(Row mask) {
+        uint32_t bytes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_packs_epi16(mask.v, mask.v)));
+        return (bytes & 0xFF) | ((bytes >> 8) & 0xFF00);
+    }
+#elif defined(BATCH_SSE2)
+    struct Row {
+        __m128i lo, hi;
+    };
+
+    inline Row load(const uint16_t *p) {
+        return { _mm_load_si128(reinterpret_cast<const __m128i *>(p)), _mm_load_si128(reinterpret_cast<const __m128i *>(p + 8)) };
+    }
+
+    inline void store(uint16_t *p, Row r) {
+        _mm_store_si128(reinterpret_cast<__m128i *>(p), r.lo);
+        _mm_store_si128(reinterpret_cast<__m128i *>(p + 8), r.hi);
+    }
+
+    inline Row splat(uint16_t x) { __m128i v = _mm_set1_epi16(static_cast<short>(x)); return { v, v }; }
+    inline Row operator&(Row a, Row b) { return { _mm_and_si128(a.lo, b.lo), _mm_and_si128(a.hi, b.hi) }; }
+    inline Row operator|(Row a, Row b) { return { _mm_or_si128(a.lo, b.lo), _mm_or_si128(a.hi, b.hi) }; }
+    inline Row operator-(Row a, Row b) { return { _mm_sub_epi16(a.lo, b.lo), _mm_sub_epi16(a.hi, b.hi) }; }
+    inline Row equal(Row a, Row b) { return { _mm_cmpeq_epi16(a.lo, b.lo), _mm_cmpeq_epi16(a.hi, b.hi) }; }
+
+    inline Row select(Row mask, Row a, Row b) {
+        return { _mm_or_si128(_mm_and_si128(mask.lo, a.lo), _mm_andnot_si128(mask.lo, b.lo)),
+                 _mm_or_si128(_mm_and_si128(mask.hi, a.hi), _mm_andnot_si128(mask.hi, b.hi)) };
+    }
+
+    inline uint32_t laneBits(Row mask) { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(mask.lo, mask.hi))); }
+    inline Row shiftLeft(Row a) { return { _mm_slli_epi16(a.lo, 1), _mm_slli_epi16(a.hi, 1) }; }
+    inline Row shiftRight(Row a) { return { _mm_srli_epi16(a.lo, 1), _mm_srli_epi16(a.hi, 1) }; }
+#else
+    struct Row {
+        uint16_t v[BoardBatch::LANES];
+    };
+
+    inline Row load(const uint16_t *p) { Row r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    inline void store(uint16_t *p, Row r) { std::memcpy(p, r.v, sizeof(r.v)); }
+    inline Row splat(uint16_t x) { Row r; for (auto &v : r.v) v = x; return r; }
+
+    template <typename Op>
+    inline Row lanewise(Row a, Row b, Op op) {
+        Row r;
+        for (int i = 0; i < BoardBatch::LANES; ++i) r.v[i] = static_cast<uint16_t>(op(a.v[i], b.v[i]));
+        return r;
+    }
+
+    inline Row operator&(Row a, Row b) { return lanewise(a, b, [](uint16_t x, uint16_t y) { return x & y; }); }
+    inline Row operator|(Row a, Row b) { return lanewise(a, b, [](uint16_t x, uint16_t y) { return x | y; }); }
+    inline Row operator-(Row a, Row b) { return lanewise(a, b, [](uint16_t x, uint16_t y) { return x - y; }); }
+    inline Row equal(Row a, Row b) { return lanewise(a, b, [](uint16_t x, uint16_t y) { return x == y ? 0xFFFF : 0; }); }
+
+    inline Row select(Row mask, Row a, Row b) {
+        Row r;
+        for (int i = 0; i < BoardBatch::LANES; ++i) r.v[i] = static_cast<uint16_t>((mask.v[i] & a.v[i]) | (~mask.v[i] & b.v[i]));
+        return r;
+    }
+
+    inline uint32_t laneBits(Row mask) {
+        uint32_t bits = 0;
+        for (int i = 0; i < BoardBatch::LANES; ++i) bits |= (mask.v[i] ? 1u : 0u) << i;
+        return bits;
+    }
+
+    inline Row shiftLeft(Row a) { for (auto &v : a.v) v = static_cast<uint16_t>(v << 1); return a; }
+    inline Row shiftRight(Row a) { for (auto &v : a.v) v = static_cast<uint16_t>(v >> 1); return a; }
+#endif
+
+    // the opposite of laneBits: all ones in the lanes whose bit is set
+    inline Row laneMask(uint32_t lanes) {
+        alignas(32) static constexpr uint16_t bits[BoardBatch::LANES] = { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768 };
+        Row b = load(bits);
+        return equal(splat(static_cast<uint16_t>(lanes)) & b, b);
+    }
+
+    // lanes in which any row of a and b overlaps
+    inline uint32_t overlapping(const uint16_t (*a)[BoardBatch::LANES], const uint16_t (*b)[BoardBatch::LANES], int count) {
+        Row overlap = splat(0);
+        for (int y = 0; y < count; ++y) overlap = overlap | (load(a[y]) & load(b[y]));
+        return ~laneBits(equal(overlap, splat(0))) & BoardBatch::ALL_LANES;
+    }
+
+    using PieceRows = uint16_t[BOARD_HEIGHT][BoardBatch::LANES];
+
+    struct PieceCells {
+        uint32_t outside; // lanes whose piece sticks out of the board, which Board::collides reports as colliding
+        int top, bottom; // rows [top, bottom) of the cells are valid; the others were never written
+    };
+
+    // Spreads the pieces of the selected lanes into an SoA board of their cells, so that collide and
+    // lock become one AND/OR per row. Like Board::lockPiece, the in-range rows of a piece that sticks
+    // out at the top or bottom are kept and a horizontally out-of-range piece has no cells at all.
+    PieceCells buildPieceRows(PieceRows &cells, const Tetromino *pieces, uint32_t lanes) {
+        PieceCells result{ 0, BOARD_HEIGHT, 0 };
+
+        for (uint32_t remaining = lanes; remaining; remaining &= remaining - 1) {
+            int y = pieces[std::countr_zero(remaining)].y;
+            result.top = std::min(result.top, std::max(y, 0));
+            result.bottom = std::max(result.bottom, std::min(y + 4, BOARD_HEIGHT));
+        }
+
+        const Row zero = splat(0);
+        for (int y = result.top; y < result.bottom; ++y) store(cells[y], zero);
+
+        for (uint32_t remaining = lanes; remaining; remaining &= remaining - 1) {
+            int lane = std::countr_zero(remaining);
+            const Tetromino &t = pieces[lane];
+
+            if (t.x < -BOARD_WALL_BITS || t.x >= BOARD_WIDTH) {
+                result.outside |= 1u << lane;
+                continue;
+            }
+
+            const PieceShape &shape = shapeOf(t);
+
+            for (int i = 0; i < 4; ++i) {
+                int by = t.y + i;
+
+                if (by < 0 || by >= BOARD_HEIGHT) {
+                    if (shape.rows[i]) result.outside |= 1u << lane;
+                    continue;
+                }
+
+                cells[by][lane] = static_cast<uint16_t>(shape.rows[i] << (t.x + BOARD_WALL_BITS));
+            }
+        }
+
+        return result;
+    }
+}
+
+BoardBatch::BoardBatch() {
+    for (int y = 0; y < BOARD_HEIGHT; ++y) {
+        store(rows[y], splat(BOARD_EMPTY_ROW));
+        store(active[y], splat(0));
+    }
+}
+
+void BoardBatch::setLane(int lane, const Board &board) {
+    for (int y = 0; y < BOARD_HEIGHT; ++y) rows[y][lane] = board.rows[y];
+}
+
+Board BoardBatch::getLane(int lane) const {
+    uint16_t laneRows[BOARD_HEIGHT];
+    for (int y = 0; y < BOARD_HEIGHT; ++y) laneRows[y] = rows[y][lane];
+
+    Board board;
+    board.loadRows(laneRows);
+    return board;
+}
+
+void BoardBatch::clearLane(int lane) {
+    for (int y = 0; y < BOARD_HEIGHT; ++y) {
+        rows[y][lane] = BOARD_EMPTY_ROW;
+        active[y][lane] = 0;
+    }
+}
+
+uint32_t BoardBatch::collides(const Tetromino *pieces, uint32_t lanes) const {
+    alignas(32) PieceRows cells;
+    PieceCells built = buildPieceRows(cells, pieces, lanes);
+
+    return (built.outside | overlapping(rows + built.top, cells + built.top, built.bottom - built.top)) & lanes;
+}
+
+void BoardBatch::lockPieces(const Tetromino *pieces, uint32_t lanes) {
+    alignas(32) PieceRows cells;
+    PieceCells built = buildPieceRows(cells, pieces, lanes);
+
+    for (int y = built.top; y < built.bottom; ++y) store(rows[y], load(rows[y]) | load(cells[y]));
+}
+
+uint32_t BoardBatch::clearLines(uint8_t *cleared) {
+    const Row full = splat(BOARD_FULL_ROW);
+    const Row empty = splat(BOARD_EMPTY_ROW);
+    Row count = splat(0);
+
+    Row anyFull = splat(0);
+    for (int y = 0; y < BOARD_HEIGHT; ++y) anyFull = anyFull | equal(load(rows[y]), full);
+
+    if (!laneBits(anyFull)) {
+        if (cleared) for (int i = 0; i < LANES; ++i) cleared[i] = 0;
+        return 0;
+    }
+
+    // bottom-up; a lane whose row y is full drops everything above by one, so row y is checked again
+    for (int y = BOARD_HEIGHT - 1; y >= 0; --y) {
+        while (true) {
+            Row isFull = equal(load(rows[y]), full);
+            if (!laneBits(isFull)) break;
+
+            count = count - isFull; // the mask is -1 in the full lanes
+
+            for (int t = y; t > 0; --t) store(rows[t], select(isFull, load(rows[t - 1]), load(rows[t])));
+            store(rows[0], select(isFull, empty, load(rows[0])));
+        }
+    }
+
+    alignas(32) uint16_t counts[LANES];
+    store(counts, count);
+
+    uint32_t lanes = 0;
+    for (int i = 0; i < LANES; ++i) {
+        if (cleared) cleared[i] = static_cast<uint8_t>(counts[i]);
+        if (counts[i]) lanes |= 1u << i;
+    }
+
+    return lanes;
+}
+
+uint32_t BoardBatch::spawnActive(const Tetromino *pieces, uint32_t lanes) {
+    alignas(32) PieceRows cells;
+    PieceCells built = buildPieceRows(cells, pieces, lanes);
+
+    Row replace = laneMask(lanes);
+    const Row zero = splat(0);
+    for (int y = 0; y < BOARD_HEIGHT; ++y) {
+        Row spawned = (y >= built.top && y < built.bottom) ? load(cells[y]) : zero;
+        store(active[y], select(replace, spawned, load(active[y])));
+    }
+
+    return (built.outside | overlapping(rows + built.top, cells + built.top, built.bottom - built.top)) & lanes;
+}
+
+// The walls are three bits wide on both sides, so a one-column move never pushes a cell out of the
+// word: leaving the board always lands it on a wall bit.
+uint32_t BoardBatch::shiftActive(uint32_t left, uint32_t right) {
+    right &= ~left;
+    Row toLeft = laneMask(left), toRight = laneMask(right);
+
+    auto moved = [&](int y) {
+        Row cells = load(active[y]);
+        return select(toLeft, shiftRight(cells), select(toRight, shiftLeft(cells), cells));
+    };
+
+    Row overlap = splat(0);
+    for (int y = 0; y < BOARD_HEIGHT; ++y) overlap = overlap | (load(rows[y]) & moved(y));
+
+    uint32_t lanes = (left | right) & laneBits(equal(overlap, splat(0)));
+    if (!lanes) return 0;
+
+    Row apply = laneMask(lanes);
+    for (int y = 0; y < BOARD_HEIGHT; ++y) store(active[y], select(apply, moved(y), load(active[y])));
+
+    return lanes;
+}
+
+uint32_t BoardBatch::dropActive(uint32_t lanes) {
+    // row y of the moved piece is row y - 1 of the current one; cells in the last row would leave the board
+    uint32_t blocked = overlapping(rows + 1, active, BOARD_HEIGHT - 1) | (~laneBits(equal(load(active[BOARD_HEIGHT - 1]), splat(0))) & ALL_LANES);
+    blocked &= lanes;
+
+    Row apply = laneMask(lanes & ~blocked);
+    for (int y = BOARD_HEIGHT - 1; y > 0; --y) store(active[y], select(apply, load(active[y - 1]), load(active[y])));
+    store(active[0], select(apply, splat(0), load(active[0])));
+
+    return blocked;
+}
+
+void BoardBatch::lockActive(uint32_t lanes) {
+    Row apply = laneMask(lanes);
+    const Row zero = splat(0);
+
+    for (int y = 0; y < BOARD_HEIGHT; ++y) {
+        Row cells = load(active[y]) & apply;
+        store(rows[y], load(rows[y]) | cells);
+        store(active[y], select(apply, zero, load(active[y])));
+    }
+}
+
+const char *BoardBatch::kernelName() {
+#if defined(BATCH_AVX2)
+    return "avx2";
+#elif defined(BATCH_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,70 @@
+#include "../include/effects.hpp"
+
+EffectScheduler::EffectScheduler() {
+    for (auto &clock : buckets)
+        for (auto &bucket : clock) bucket = NONE;
+
+    for (int i = 0; i < CAPACITY; ++i) entries[i].next = static_cast<uint8_t>(i + 1 < CAPACITY ? i + 1 : NONE);
+}
+
+// an effect that is already due goes into the next bucket, so it expires on the next advance
+void EffectScheduler::link(uint8_t index) {
+    Entry &e = entries[index];
+    uint64_t current = now[static_cast<int>(e.clock)];
+    e.slot = static_cast<uint8_t>((e.due > current ? e.due : current + 1) & (SLOTS - 1));
+
+    uint8_t &head = buckets[static_cast<int>(e.clock)][e.slot];
+    e.next = head;
+    head = index;
+}
+
+void EffectScheduler::unlink(uint8_t index) {
+    Entry &e = entries[index];
+
+    for (uint8_t *link = &buckets[static_cast<int>(e.clock)][e.slot]; *link != NONE; link = &entries[*link].next) {
+        if (*link == index) {
+            *link = e.next;
+            return;
+        }
+    }
+}
+
+void EffectScheduler::release(uint8_t index) {
+    Entry &e = entries[index];
+    e.live = false;
+    ++e.generation; // outstanding handles stop matching
+    e.next = freeList;
+    freeList = index;
+}
+
+EffectHandle EffectScheduler::schedule(EffectClock clock, uint64_t due, EffectKind kind, int value) {
+    if (freeList == NONE) return {};
+
+    uint8_t index = freeList;
+    Entry &e = entries[index];
+    freeList = e.next;
+
+    e.due = due;
+    e.effect = { kind, value };
+    e.clock = clock;
+    e.live = true;
+    link(index);
+
+    return { index, e.generation };
+}
+
+bool EffectScheduler::reschedule(EffectHandle h, uint64_t due) {
+    if (!pending(h)) return false;
+
+    unlink(h.index);
+    entries[h.index].due = due;
+    link(h.index);
+    return true;
+}
+
+void EffectScheduler::cancel(EffectHandle h) {
+    if (!pending(h)) return;
+
+    unlink(h.index);
+    release(h.index);
+}
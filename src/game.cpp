@@ -1,307 +1,285 @@
 #include "../include/game.hpp"
 #include "../include/platform.hpp"
-#include "../include/tetromino.hpp"
+#include "../include/trace.hpp"
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <chrono>
 
-Game::Game(): current(), next(), gameOver(false), tick(0), score(0), level(0), totalLinesCleared(0), ticksPerDrop(baseTicksPerDrop), highscoreManager("highscore.txt") {
-    current = createRandomPiece();
-    current.x = BOARD_WIDTH / 2 - 2; // center the piece
-    current.y = 0;
+Game::Game(uint64_t seed, Randomizer randomizer): state(seed, randomizer) {}
 
-    next = createRandomPiece(); // next piece
-}
+void Game::drawNextPiece(const Tetromino &next) {
+    TRACE_SPAN("Game::drawNextPiece");
 
-void Game::fillBottomHole() {
-    for (int y = BOARD_HEIGHT - 1; y >= 0; --y) {
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            if (board.grid[y][x] == 0) {
-                board.grid[y][x] = 1;
-                return;
-            }
-        }
-    }
-}
+    const int top = BOARD_HEIGHT + 4; // below the board frame and one blank line
+    const PieceShape &shape = shapeOf(next);
 
-void Game::activateSlowForSpawnedPiece() {
-    if (slowPiecesRemaining > 0) {
-        slowActiveForCurrent = true;
-        slowPiecesRemaining -= 1;
-    } else {
-        slowActiveForCurrent = false;
-    }
-}
+    renderer.text(top, 0, " Next:");
 
-void Game::skipCurrentPiece() {
-    current = next;
-    current.x = BOARD_WIDTH / 2 - 2;
-    current.y = 0;
-    next = createRandomPiece();
+    for (int y = 0; y < 4; ++y) {
+        int col = 2;
 
-    activateSlowForSpawnedPiece(); // when skipping, the new current is considered a newly spawned piece -> activate slow for it if available
+        for (int x = 0; x < 4; ++x) {
+            renderer.put(top + 1 + y, col++, U' ');
+            renderer.put(top + 1 + y, col++, (shape.rows[y] & (1u << x)) ? U'#' : U'.');
+        }
+    }
 }
 
-void Game::applySlowToActivePiece(int factor) {
-    if (factor <= 1) return;
-    slowPiecesRemaining += 3;
-    slowFactorActive = factor;
+void Game::render(const FrameSnapshot &frame) {
+    TRACE_SPAN("render");
+    renderer.clear();
 
-    // immediately apply to the currently active piece as well
-    if (!slowActiveForCurrent && slowPiecesRemaining > 0) {
-        slowActiveForCurrent = true;
-        slowPiecesRemaining -= 1;
+    {
+        TRACE_SPAN("Board::draw");
+        frame.board.draw(renderer, frame.current, frame.score, frame.level, frame.highscore, frame.note.view());
     }
-}
 
-void Game::deleteTopRows(int n) {
-    if (n <= 0) return;
-    int removed = 0;
+    drawNextPiece(frame.next);
 
-    for (int y = 0; y < BOARD_HEIGHT && removed < n; ++y) {
-        bool hasLocked = false;
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            if (board.grid[y][x] == 1) {
-                hasLocked = true;
-                break;
-            }
-        }
+    TRACE_SPAN("Renderer::present");
+    renderer.present();
+}
 
-        if (hasLocked) {
-            for (int ty = y; ty > 0; --ty)
-                for (int tx = 0; tx < BOARD_WIDTH; ++tx)
-                    board.grid[ty][tx] = board.grid[ty - 1][tx];
+void Game::publishFrame() {
+    FrameSnapshot &frame = frames.back();
+    frame.board = state.getBoard();
+    frame.current = state.getCurrent();
+    frame.next = state.getNext();
+    frame.score = state.getScore();
+    frame.level = state.getLevel();
+    frame.highscore = highscore;
+    frame.note.clear();
+    frame.note.append(state.getSideNote());
+    frame.seq = ++publishedSeq;
+    frame.inputSince = inputSince;
+
+    frames.publish();
+    frameReady.ring();
+}
 
-            for (int tx = 0; tx < BOARD_WIDTH; ++tx) board.grid[0][tx] = 0;
+void Game::inputLoop() {
+    while (running.load(std::memory_order_acquire)) {
+        bool keyReady = platform::waitForInput(platform::Clock::now() + inputPollInterval);
 
-            ++removed;
-            --y; // re-check
+        // the resize signal may have interrupted another thread, so check even after a timeout
+        if (platform::consumeResize()) {
+            repaint.store(true, std::memory_order_release);
+            frameReady.ring();
         }
-    }
-}
-
-void Game::drawNextPiece() const {
-    std::cout << "\n Next:\n";
 
-    for (int y = 0; y < 4; ++y) {
-        std::cout << "  ";
+        bool pushed = false;
 
-        for (int x = 0; x < 4; ++x) {
-            if (next.shape[y][x] == 1) std::cout << " #";
-            else std::cout << " .";
+        while (keyReady && platform::kbhit()) {
+            // a simulation more than 256 keys behind has stopped anyway; drop the excess
+            pushed |= inputs.push({ platform::getch(), platform::Clock::now() });
         }
 
-        std::cout << "\n";
+        if (pushed) inputReady.ring();
     }
 }
 
-void Game::hardDrop() {
-    Tetromino temp = current;
+void Game::renderLoop() {
+    platform::Clock::time_point lastMeasured{};
 
     while (true) {
-        Tetromino nextpos = temp;
-        nextpos.y++;
-        if (board.collides(nextpos)) break;
-        temp = nextpos;
-    }
+        bool last = !running.load(std::memory_order_acquire); // the final frame was published before
+        bool fresh = frames.take(); // stale frames published in between are skipped
 
-    current = temp;
-    board.lockPiece(current);
-    int cleared = board.clearLines();
-    if (cleared > 0) onLinesCleared(cleared);
+        if (repaint.exchange(false, std::memory_order_acq_rel)) {
+            renderer.invalidate(); // the terminal may have reflowed: repaint everything
+            fresh = true;
+        }
 
-    // if the piece that just locked had the 3x-speed effect active, consume it and clear the note
-    if (speedNoteActive) {
-        speedNoteActive = false;
-        activeSpeedMultiplier = 1;
-    }
-}
+        if (fresh) {
+            const FrameSnapshot &frame = frames.front();
 
-void Game::run() {
-    std::cout << "\033[?25l"; // hide cursor
-    std::cout << "\033[2J"; // clear screen once
-
-    // apply any scheduled speed effect before starting (unlikely at startup, but safe)
-    if (nextSpeedMultiplier > 1) {
-        activeSpeedMultiplier = nextSpeedMultiplier;
-        nextSpeedMultiplier = 1;
-        speedNoteActive = (activeSpeedMultiplier > 1);
-        speedNotePending = false;
-    }
-
-    if (mode) mode->onStart(*this);
+            auto begin = platform::Clock::now();
+            render(frame);
+            auto shown = platform::Clock::now();
 
-    activateSlowForSpawnedPiece(); // activate slow for the first piece if scheduled
+            telemetry.frameTime.add(shown - begin);
 
-    while (!gameOver) {
-        board.clearPiece();
+            // frames repeat inputSince until the game sees this one shown, so count each key once
+            if (frame.inputSince != platform::Clock::time_point{} && frame.inputSince != lastMeasured) {
+                telemetry.inputLatency.add(shown - frame.inputSince);
+                lastMeasured = frame.inputSince;
+            }
 
-        if (platform::kbhit()) {
-            int c = platform::getch();
-            Tetromino temp = current;
+            presentedSeq.store(frame.seq, std::memory_order_release);
+        }
 
-            if (c == 'a') {
-                temp.x--;
-                if (!board.collides(temp)) current = temp;
-            } else if (c == 'd') {
-                temp.x++;
-                if (!board.collides(temp)) current = temp;
-            } else if (c == 's') {
-                temp.y++;
-                if (!board.collides(temp)) current = temp;
-            } else if (c == 'w') {
-                Tetromino rot = current;
-                rotateClockwise(rot);
+        if (last) break;
+        frameReady.wait();
+    }
+}
 
-                if (!board.collides(rot)) current = rot;
-                else {
-                    static const int kicks[] = { -1, 1, -2, 2, -3, 3 };
+bool Game::applyInput(int key) {
+    recorder.record(state.getTick(), key);
+    return state.applyInput(key);
+}
 
-                    for (int kick : kicks) {
-                        rot.x += kick;
+void Game::applyAutoRepeat(platform::Clock::time_point now) {
+    int steps = autoRepeat.due(now);
+    if (steps == AutoRepeat::UNLIMITED) steps = BOARD_HEIGHT; // enough to reach any wall or the floor
 
-                        if (!board.collides(rot)) {
-                            current = rot; break;
-                        }
+    int key = autoRepeat.heldKey();
+    for (int i = 0; i < steps && !state.isGameOver(); ++i)
+        if (!applyInput(key)) break;
+}
 
-                        rot.x -= kick;
+void Game::run() {
+    std::cout << "\033[?25l" << std::flush; // hide cursor; the renderer clears the screen with its first frame
+    renderer.invalidate();
+
+    uint64_t replayId = newReplayId();
+    std::string replayPath = replayPathFor(replayId);
+    std::string modeName(::modeName(state.getMode()));
+    recorder.open(replayPath, state.getSeed(), state.getRandomizer(), modeName);
+
+    highscore = highscoreManager.getHighscore(modeName);
+    state.start();
+
+    auto nextTick = platform::Clock::now();
+    telemetry.started = nextTick;
+    telemetry.autoplay = autoplay;
+
+    publishFrame();
+    running.store(true, std::memory_order_release);
+    std::thread renderThread(&Game::renderLoop, this);
+    std::thread inputThread(&Game::inputLoop, this);
+
+    while (!state.isGameOver()) {
+        // sleep until a key arrives, a held key is due to repeat or the next gravity tick is due
+        inputReady.waitUntil(std::min(nextTick, autoRepeat.nextDeadline()));
+        auto now = platform::Clock::now();
+
+        if (inputSince != platform::Clock::time_point{} && presentedSeq.load(std::memory_order_acquire) >= inputSeq)
+            inputSince = {}; // those keys are on screen
+
+        {
+            TRACE_SPAN("input");
+
+            // drain every pending key at once so fast input never queues up behind the tick
+            InputEvent event;
+            while (!state.isGameOver() && inputs.pop(event)) {
+                if (!autoplay && autoRepeat.onKey(event.key, event.time)) {
+                    applyInput(event.key);
+
+                    if (inputSince == platform::Clock::time_point{}) {
+                        inputSince = event.time;
+                        inputSeq = publishedSeq + 1;
                     }
                 }
-            } else if (c == ' ') {
-                hardDrop();
-
-                if (mode) mode->onLock(*this); // before spawning next, allow mode to schedule effects for the upcoming piece
-
-                // show indicator for the upcoming piece
-                if (speedNotePending) {
-                    board.draw(score, level, highscoreManager.getHighscore(), "3x speed for NEXT piece");
-                    std::cout << std::flush;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(800));
-                }
+            }
 
-                activeSpeedMultiplier = nextSpeedMultiplier;
-                nextSpeedMultiplier = 1;
+            applyAutoRepeat(now);
+        }
 
-                // pending note moves to active when the scheduled effect is applied
-                speedNoteActive = activeSpeedMultiplier > 1;
-                if (speedNoteActive) speedNotePending = false;
+        if (now >= nextTick && !state.isGameOver()) {
+            TRACE_SPAN("tick");
+            state.advanceTick();
+            nextTick += tickDuration;
+        }
 
-                current = next;
-                current.x = BOARD_WIDTH / 2 - 2;
-                current.y = 0;
-                next = createRandomPiece();
-                if (board.collides(current)) gameOver = true;
+        // the autoplayer moves right after each tick, before gravity can touch a freshly spawned piece
+        if (autoplay)
+            for (auto keys = autoPlayer.update(state); !keys.empty(); keys = autoPlayer.update(state))
+                for (int key : keys) applyInput(key);
 
-                activateSlowForSpawnedPiece(); // after spawn, activate slow if scheduled
-            }
+        // after a stall longer than a tick (e.g. a suspended process) resume from now instead of replaying missed ticks
+        now = platform::Clock::now();
+        if (now - nextTick > tickDuration) nextTick = now;
 
-            if (mode) mode->onInput(*this, c);
-        }
+        publishFrame(); // presents nothing if the frame did not change
+    }
 
-        // auto-drop logic
-        int effectiveTicksPerDrop = ticksPerDrop;
-        if (slowActiveForCurrent) effectiveTicksPerDrop = ticksPerDrop * slowFactorActive;
+    // the render thread presents the final frame before it stops
+    running.store(false, std::memory_order_release);
+    frameReady.ring();
+    renderThread.join();
+    inputThread.join();
 
-        if (tick % std::max(1, effectiveTicksPerDrop / activeSpeedMultiplier) == 0) {
-            Tetromino temp = current;
-            temp.y++;
+    appendTelemetry("telemetry.jsonl", state, telemetry, platform::Clock::now());
 
-            if (!board.collides(temp)) current = temp;
-            else {
-                board.lockPiece(current);
-                int cleared = board.clearLines();
-                if (cleared > 0) onLinesCleared(cleared);
+    bool recorded = recorder.isOpen();
+    recorder.finish(state.getTick());
 
-                // if the piece that just locked had the 3x-speed effect active, consume it and clear the note
-                if (speedNoteActive) {
-                    speedNoteActive = false;
-                    activeSpeedMultiplier = 1;
-                }
+    std::cout << "\nGAME OVER! Game closes shortly.\n";
+    std::cout << "Seed: " << state.getSeed() << "\n";
+    if (recorded) std::cout << "Replay saved to " << replayPath << "\n";
 
-                // if slow-note active for this piece, consume it now
-                if (slowActiveForCurrent) {
-                    slowActiveForCurrent = false;
-                }
+    // the entry is written by the leaderboard's background thread while the game-over screen shows
+    LeaderboardEntry entry;
+    entry.score = state.getScore();
+    entry.lines = state.getLinesCleared();
+    entry.level = state.getLevel();
+    entry.date = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    entry.replayId = recorded ? replayId : 0;
 
-                if (mode) mode->onLock(*this); // allow mode to schedule an effect for the next piece
+    int rank = state.getScore() > 0 ? highscoreManager.submit(modeName, entry) : -1;
 
-                // show indicator for the upcoming piece
-                if (speedNotePending) {
-                    board.draw(score, level, highscoreManager.getHighscore(), "3x speed for NEXT piece");
-                    std::cout << std::flush;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(800));
-                }
+    if (rank == 0) std::cout << "New " << modeName << " highscore: " << state.getScore() << "\n";
+    else if (rank > 0) std::cout << "Leaderboard place " << rank + 1 << " in " << modeName << " mode\n";
+    else std::cout << modeName << " highscore: " << highscoreManager.getHighscore(modeName) << "\n";
 
-                activeSpeedMultiplier = nextSpeedMultiplier;
-                nextSpeedMultiplier = 1;
+    std::cout << std::flush;
+    std::this_thread::sleep_for(std::chrono::seconds(5));
 
-                // pending note moves to active when the scheduled effect is applied
-                speedNoteActive = activeSpeedMultiplier > 1;
-                if (speedNoteActive) speedNotePending = false;
+    std::cout << "\033[?25h"; // show cursor
+}
 
-                current = next;
-                current.x = BOARD_WIDTH / 2 - 2;
-                current.y = 0;
-                next = createRandomPiece();
-                if (board.collides(current)) gameOver = true;
+void Game::replay(ReplayReader &reader, int speed) {
+    std::cout << "\033[?25l" << std::flush;
+    renderer.invalidate();
 
-                activateSlowForSpawnedPiece(); // after spawn, activate slow if scheduled
-            }
-        }
+    highscore = highscoreManager.getHighscore(reader.getModeName());
+    state.start();
 
-        if (mode) mode->onTick(*this, tick);
+    const auto tick = std::chrono::duration_cast<platform::Clock::duration>(tickDuration) / std::max(speed, 1);
+    auto nextTick = platform::Clock::now();
 
-        board.drawPiece(current);
+    // playback reads no keys, so it only needs the render thread
+    publishFrame();
+    running.store(true, std::memory_order_release);
+    std::thread renderThread(&Game::renderLoop, this);
 
-        if (speedNoteActive) {
-            board.draw(score, level, highscoreManager.getHighscore(), "3x speed ACTIVE");
-        } else if (speedNotePending) {
-            board.draw(score, level, highscoreManager.getHighscore(), "3x speed for NEXT piece");
-        } else {
-            std::string note = "";
-            if (mode) note = mode->getSideNote(*this);
-            board.draw(score, level, highscoreManager.getHighscore(), note);
+    while (!state.isGameOver() && !reader.finished(state.getTick())) {
+        // keys typed during playback are ignored; waiting on input still lets a resize repaint at once
+        if (platform::waitForInput(nextTick)) {
+            while (platform::kbhit()) platform::getch();
+            continue;
         }
 
-        drawNextPiece();
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        ++tick;
-    }
-
-    std::cout << "\nGAME OVER! Game closes shortly.\n";
+        if (platform::consumeResize()) {
+            repaint.store(true, std::memory_order_release);
+            frameReady.ring();
+        }
 
-    if (highscoreManager.saveIfHigher(score)) {
-        std::cout << "New highscore saved: " << score << "\n";
-    } else {
-        std::cout << "Highscore: " << highscoreManager.getHighscore() << "\n";
-    }
+        if (platform::Clock::now() < nextTick) continue;
 
-    std::cout << std::flush;
-    std::this_thread::sleep_for(std::chrono::seconds(5));
+        // the events of a tick were applied before it advanced while recording, so do the same here
+        {
+            TRACE_SPAN("input");
+            while (reader.hasEventAt(state.getTick())) state.applyInput(reader.take().key);
+        }
 
-    std::cout << "\033[?25h"; // show cursor
-}
+        {
+            TRACE_SPAN("tick");
+            state.advanceTick();
+            nextTick += tick;
+        }
 
-// Leveling and scoring rules
-void Game::onLinesCleared(int cleared) {
-    int points = 0;
+        auto now = platform::Clock::now();
+        if (now - nextTick > tick) nextTick = now;
 
-    switch (cleared) {
-        case 1: points = 40 * (level + 1); break;
-        case 2: points = 100 * (level + 1); break;
-        case 3: points = 300 * (level + 1); break;
-        case 4: points = 1200 * (level + 1); break;
-        default: points = 0; break;
+        publishFrame();
     }
 
-    score += points;
-    totalLinesCleared += cleared;
+    running.store(false, std::memory_order_release);
+    frameReady.ring();
+    renderThread.join();
 
-    int newLevel = totalLinesCleared / linesPerLevel;
-
-    if (newLevel > level) {
-        level = newLevel;
-        ticksPerDrop = std::max(1, baseTicksPerDrop - level);
-    }
+    std::cout << "\nREPLAY FINISHED. Score: " << state.getScore() << "  Lines: " << state.getLinesCleared() << "  Ticks: " << state.getTick() << "\n";
+    std::cout << "\033[?25h" << std::flush;
 }
@@ -0,0 +1,262 @@
+#include "../include/game_state.hpp"
+#include "../include/trace.hpp"
+#include <algorithm>
+
+GameState::GameState(uint64_t seed, Randomizer randomizer): seed(seed), randomizer(randomizer), queue(seed, randomizer), modeRng(seed, 1), current(), next(), gameOver(false), tick(0), score(0), level(0), totalLinesCleared(0), gravity(gravityForLevel(0)) {
+    next = createPiece(queue.pop());
+    spawnNext();
+}
+
+void GameState::spawnNext() {
+    current = next;
+    current.x = BOARD_WIDTH / 2 - 2; // center the piece
+    current.y = 0;
+    ++piecesSpawned;
+
+    next = createPiece(queue.pop());
+    effects.advance(EffectClock::Spawn, piecesSpawned, [&](const auto &e) { onEffectExpired(e); });
+}
+
+void GameState::start() {
+    std::visit([&](auto &m) {
+        if constexpr (requires { m.onStart(*this); }) {
+            TRACE_SPAN("Mode::onStart");
+            m.onStart(*this);
+        }
+    }, mode);
+}
+
+GameEvents GameState::takeEvents() {
+    GameEvents e = events;
+    events = GameEvents();
+    return e;
+}
+
+std::string_view GameState::getSideNote() const {
+    if (effects.pending(speedNotice)) return "3x speed for this piece!";
+    if (speedMultiplier > 1) return "3x speed ACTIVE";
+
+    return std::visit([](const auto &m) -> std::string_view {
+        if constexpr (requires { m.getSideNote(); }) {
+            TRACE_SPAN("Mode::getSideNote");
+            return m.getSideNote();
+        } else {
+            return {};
+        }
+    }, mode);
+}
+
+void GameState::fillBottomHole() {
+    if (board.fillBottomHole()) ++effectCounts.holesFilled;
+}
+
+void GameState::skipCurrentPiece() {
+    ++effectCounts.piecesSkipped;
+    spawnNext(); // counts as a spawn, so the replacement uses up one piece of a running slow
+}
+
+// a slow that is still running is extended by another slowPieces pieces
+void GameState::applySlowToActivePiece(int factor) {
+    if (factor <= 1) return;
+    ++effectCounts.slowsApplied;
+
+    if (effects.pending(slow)) effects.reschedule(slow, effects.dueOf(slow) + slowPieces);
+    else slow = effects.schedule(EffectClock::Spawn, piecesSpawned + slowPieces, EffectKind::Slow);
+
+    if (effects.pending(slow)) slowFactor = factor;
+}
+
+// called from a lock hook, before the next piece spawns: the speed-up lasts until that piece locks
+void GameState::scheduleNextSpeedMultiplier(int m) {
+    if (m <= 1) return;
+    ++effectCounts.speedUps;
+
+    if (!effects.pending(speedUp)) speedUp = effects.schedule(EffectClock::Lock, piecesLocked + 1, EffectKind::SpeedUp);
+    if (!effects.pending(speedUp)) return;
+    speedMultiplier = m;
+
+    // announced next to the board for a while; play goes on meanwhile
+    effects.cancel(speedNotice);
+    speedNotice = effects.schedule(EffectClock::Tick, tick + noticeTicks, EffectKind::Notice);
+    events.speedWarning = true;
+}
+
+void GameState::onEffectExpired(const EffectScheduler::Effect &effect) {
+    switch (effect.kind) {
+        case EffectKind::SpeedUp: speedMultiplier = 1; break;
+        case EffectKind::Slow: slowFactor = 1; break;
+        default: break; // notices and cooldowns are only ever asked whether they are still pending
+    }
+}
+
+void GameState::deleteTopRows(int n) {
+    if (n <= 0) return;
+    if (board.deleteTopRows(n) > 0) ++effectCounts.rowDeletes;
+}
+
+void GameState::hardDrop() {
+    current.y += board.dropDistance(current);
+    lockAndSpawn();
+}
+
+bool GameState::applyInput(int c) {
+    if (gameOver) return false; // keys that arrive after the top-out (replays, the autoplayer) change nothing
+
+    Tetromino temp = current;
+    bool moved = false;
+
+    if (c == 'a') {
+        temp.x--;
+        if (!board.collides(temp)) { current = temp; moved = true; onPieceMoved(); }
+    } else if (c == 'd') {
+        temp.x++;
+        if (!board.collides(temp)) { current = temp; moved = true; onPieceMoved(); }
+    } else if (c == 's') {
+        temp.y++;
+        if (!board.collides(temp)) { current = temp; moved = true; }
+    } else if (c == 'w') {
+        if (rotateWithKicks(board, current)) onPieceMoved();
+    } else if (c == ' ') {
+        hardDrop();
+    }
+
+    std::visit([&](auto &m) {
+        if constexpr (requires { m.onInput(*this, c); }) {
+            TRACE_SPAN("Mode::onInput");
+            m.onInput(*this, c);
+        }
+    }, mode);
+
+    return moved;
+}
+
+void GameState::advanceTick() {
+    if (!gameOver) stepGravity();
+
+    std::visit([&](auto &m) {
+        if constexpr (requires { m.onTick(*this, tick); }) {
+            TRACE_SPAN("Mode::onTick");
+            m.onTick(*this, tick);
+        }
+    }, mode);
+
+    ++tick;
+    effects.advance(EffectClock::Tick, tick, [&](const auto &e) { onEffectExpired(e); });
+}
+
+void step(GameState &state, std::span<const int> inputs) {
+    for (int key : inputs) state.applyInput(key);
+    state.advanceTick();
+}
+
+// Levels 0-8 keep the classic 10 - level ticks per row; from level 9 (one row per tick) the
+// speed keeps growing by 25% per level until it reaches 20G. Fractions round up, so n ticks
+// always add up to a full row even though the accumulator starts empty for every piece.
+int GameState::gravityForLevel(int level) {
+    if (level < baseTicksPerDrop - 1) {
+        int ticks = baseTicksPerDrop - level;
+        return (gravityUnit + ticks - 1) / ticks;
+    }
+
+    long long g = gravityUnit;
+    for (int l = baseTicksPerDrop - 1; l < level && g < maxGravity; ++l) g = g * 5 / 4;
+
+    return static_cast<int>(std::min<long long>(g, maxGravity));
+}
+
+int GameState::effectiveGravity() const {
+    long long g = (static_cast<long long>(gravity) * speedMultiplier + slowFactor - 1) / slowFactor; // rounded up like gravityForLevel
+
+    return static_cast<int>(std::clamp<long long>(g, 1, maxGravity));
+}
+
+bool GameState::isResting() const {
+    Tetromino below = current;
+    below.y++;
+    return board.collides(below);
+}
+
+void GameState::onPieceMoved() {
+    if (lockTicks > 0 && lockResets < maxLockResets) {
+        lockTicks = 0;
+        ++lockResets;
+    }
+}
+
+void GameState::stepGravity() {
+    TRACE_SPAN("gravity");
+
+    // auto-drop logic: accumulate fractional rows and fall as many whole rows as are due
+    gravityAccumulator += effectiveGravity();
+    int rows = gravityAccumulator / gravityUnit;
+    gravityAccumulator %= gravityUnit;
+
+    current.y += std::min(rows, board.dropDistance(current));
+
+    if (!isResting()) {
+        lockTicks = 0;
+        return;
+    }
+
+    gravityAccumulator = 0; // a resting piece does not bank gravity for later
+    if (++lockTicks >= lockDelayTicks) lockAndSpawn();
+}
+
+void GameState::lockAndSpawn() {
+    TRACE_SPAN("lock");
+
+    board.lockPiece(current);
+    int cleared;
+    uint32_t clearedRows;
+    {
+        TRACE_SPAN("Board::clearLines");
+        cleared = board.clearLines(&clearedRows);
+    }
+    if (cleared > 0) onLinesCleared(cleared);
+
+    ++piecesLocked;
+    events.piecesLocked++;
+    events.linesCleared += cleared;
+    if (cleared > 0) events.clearedRows = clearedRows;
+
+    // ends the speed-up of the piece that just locked and the cooldowns that were waiting for it
+    effects.advance(EffectClock::Lock, piecesLocked, [&](const auto &e) { onEffectExpired(e); });
+
+    std::visit([&](auto &m) {
+        if constexpr (requires { m.onLock(*this); }) {
+            TRACE_SPAN("Mode::onLock");
+            m.onLock(*this); // allow mode to schedule an effect for the next piece
+        }
+    }, mode);
+
+    spawnNext(); // ends a slow whose last piece just locked
+    if (board.collides(current)) gameOver = true;
+
+    gravityAccumulator = 0;
+    lockTicks = 0;
+    lockResets = 0;
+}
+
+// Leveling and scoring rules
+void GameState::onLinesCleared(int cleared) {
+    ++clearsBySize[std::min(cleared, 4) - 1];
+    int points = 0;
+
+    switch (cleared) {
+        case 1: points = 40 * (level + 1); break;
+        case 2: points = 100 * (level + 1); break;
+        case 3: points = 300 * (level + 1); break;
+        case 4: points = 1200 * (level + 1); break;
+        default: points = 0; break;
+    }
+
+    score += points;
+    totalLinesCleared += cleared;
+
+    int newLevel = totalLinesCleared / linesPerLevel;
+
+    if (newLevel > level) {
+        level = newLevel;
+        gravity = gravityForLevel(level);
+    }
+}
@@ -1,36 +1,292 @@
 #include "../include/highscore.hpp"
+#include "../include/platform.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-#include <iostream>
 
-HighscoreManager::HighscoreManager(const std::string &path): highscore(0), path(path) {
+// File layout (little endian): "ATLB", version, TOP_N, mode count, one reserved byte, then per mode
+// a 15-byte NUL-padded name, an entry count and TOP_N entries of 32 bytes each.
+namespace {
+    constexpr char MAGIC[4] = { 'A', 'T', 'L', 'B' };
+    constexpr uint8_t VERSION = 1;
+    constexpr size_t HEADER_SIZE = 8;
+    constexpr size_t ENTRY_SIZE = 32;
+    constexpr size_t BOARD_SIZE = HighscoreManager::MAX_MODE_NAME + 1 + HighscoreManager::TOP_N * ENTRY_SIZE;
+    constexpr size_t MAX_FILE_SIZE = HEADER_SIZE + HighscoreManager::MAX_MODES * BOARD_SIZE;
+
+    using Table = HighscoreManager::Table;
+    using ModeBoard = HighscoreManager::ModeBoard;
+
+    void putLE(unsigned char *&out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) *out++ = static_cast<unsigned char>(value >> (8 * i));
+    }
+
+    uint64_t getLE(const unsigned char *&in, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(*in++) << (8 * i);
+        return value;
+    }
+
+    size_t encode(const Table &table, unsigned char *buffer) {
+        unsigned char *out = buffer;
+
+        std::memcpy(out, MAGIC, sizeof(MAGIC));
+        out += sizeof(MAGIC);
+        putLE(out, VERSION, 1);
+        putLE(out, HighscoreManager::TOP_N, 1);
+        putLE(out, static_cast<uint64_t>(table.modes), 1);
+        putLE(out, 0, 1);
+
+        for (int m = 0; m < table.modes; ++m) {
+            const ModeBoard &board = table.boards[m];
+
+            std::memcpy(out, board.name, HighscoreManager::MAX_MODE_NAME);
+            out += HighscoreManager::MAX_MODE_NAME;
+            putLE(out, static_cast<uint64_t>(board.count), 1);
+
+            for (const LeaderboardEntry &e : board.entries) {
+                putLE(out, static_cast<uint32_t>(e.score), 4);
+                putLE(out, static_cast<uint32_t>(e.lines), 4);
+                putLE(out, static_cast<uint32_t>(e.level), 4);
+                putLE(out, 0, 4);
+                putLE(out, static_cast<uint64_t>(e.date), 8);
+                putLE(out, e.replayId, 8);
+            }
+        }
+
+        return static_cast<size_t>(out - buffer);
+    }
+
+    bool decode(const unsigned char *buffer, size_t size, Table &table) {
+        table = Table();
+        if (size < HEADER_SIZE || std::memcmp(buffer, MAGIC, sizeof(MAGIC)) != 0) return false;
+
+        const unsigned char *in = buffer + sizeof(MAGIC);
+        int version = static_cast<int>(getLE(in, 1));
+        int topN = static_cast<int>(getLE(in, 1));
+        int modes = static_cast<int>(getLE(in, 1));
+        in += 1;
+
+        if (version != VERSION || topN != HighscoreManager::TOP_N || modes > HighscoreManager::MAX_MODES) return false;
+        if (size < HEADER_SIZE + modes * BOARD_SIZE) return false;
+
+        table.modes = modes;
+
+        for (int m = 0; m < modes; ++m) {
+            ModeBoard &board = table.boards[m];
+
+            std::memcpy(board.name, in, HighscoreManager::MAX_MODE_NAME);
+            board.name[HighscoreManager::MAX_MODE_NAME] = '\0';
+            in += HighscoreManager::MAX_MODE_NAME;
+            board.count = std::min(static_cast<int>(getLE(in, 1)), HighscoreManager::TOP_N);
+
+            for (LeaderboardEntry &e : board.entries) {
+                e.score = static_cast<int32_t>(getLE(in, 4));
+                e.lines = static_cast<int32_t>(getLE(in, 4));
+                e.level = static_cast<int32_t>(getLE(in, 4));
+                in += 4;
+                e.date = static_cast<int64_t>(getLE(in, 8));
+                e.replayId = getLE(in, 8);
+            }
+        }
+
+        return true;
+    }
+
+    enum class ReadResult { Loaded, Missing, Unreadable, Corrupt };
+
+    // Only a missing file is the same as an empty table; callers must not replace a file they
+    // could not read or decode.
+    ReadResult readTable(const std::string &path, Table &table) {
+        unsigned char buffer[MAX_FILE_SIZE];
+        table = Table();
+
+        std::FILE *f = std::fopen(path.c_str(), "rb");
+        if (!f) return errno == ENOENT ? ReadResult::Missing : ReadResult::Unreadable;
+
+        size_t size = std::fread(buffer, 1, sizeof(buffer), f);
+        bool failed = std::ferror(f) != 0;
+        std::fclose(f);
+        if (failed) return ReadResult::Unreadable;
+
+        if (decode(buffer, size, table)) return ReadResult::Loaded;
+
+        table = Table();
+        return ReadResult::Corrupt;
+    }
+
+    int findBoard(const Table &table, std::string_view mode) {
+        for (int m = 0; m < table.modes; ++m)
+            if (mode == table.boards[m].name) return m;
+
+        return -1;
+    }
+
+    bool contains(const ModeBoard &board, const LeaderboardEntry &e) {
+        return std::any_of(board.entries, board.entries + board.count, [&](const LeaderboardEntry &o) {
+            return o.score == e.score && o.lines == e.lines && o.level == e.level && o.date == e.date && o.replayId == e.replayId;
+        });
+    }
+
+    // Returns the entry's rank, or -1 if it is not good enough or there is no room for another mode.
+    int insert(Table &table, std::string_view mode, const LeaderboardEntry &entry) {
+        mode = mode.substr(0, HighscoreManager::MAX_MODE_NAME);
+        int index = findBoard(table, mode);
+
+        if (index < 0) {
+            if (table.modes == HighscoreManager::MAX_MODES) return -1;
+
+            index = table.modes++;
+            table.boards[index] = ModeBoard();
+            mode.copy(table.boards[index].name, mode.size());
+        }
+
+        ModeBoard *board = &table.boards[index];
+
+        // equal scores keep their order: the older entry stays ahead
+        int rank = 0;
+        while (rank < board->count && board->entries[rank].score >= entry.score) ++rank;
+        if (rank == HighscoreManager::TOP_N) return -1;
+
+        int last = std::min(board->count, HighscoreManager::TOP_N - 1);
+        for (int i = last; i > rank; --i) board->entries[i] = board->entries[i - 1];
+
+        board->entries[rank] = entry;
+        board->count = std::min(board->count + 1, HighscoreManager::TOP_N);
+        return rank;
+    }
+}
+
+HighscoreManager::HighscoreManager(const std::string &path, const std::string &legacyPath): path(path), legacyPath(legacyPath) {
     load();
 }
 
-int HighscoreManager::getHighscore() const {
-    return highscore;
+HighscoreManager::~HighscoreManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+    if (writer.joinable()) writer.join();
 }
 
 void HighscoreManager::load() {
-    std::ifstream in(path);
+    // a damaged file is set aside by the next save rather than migrated over
+    if (readTable(path, table) != ReadResult::Missing) return;
+
+    // first start with this version: carry the old shared highscore over into the Normal board
+    std::ifstream in(legacyPath);
+    int value = 0;
 
-    if (!in) {
-        highscore = 0;
-        return;
+    if (in >> value && value > 0) {
+        LeaderboardEntry migrated;
+        migrated.score = value;
+        insert(table, "Normal", migrated);
+        queueSave("Normal", migrated);
     }
+}
 
-    int value = 0;
-    if (in >> value) highscore = value;
-    else highscore = 0;
+int HighscoreManager::getHighscore(std::string_view mode) const {
+    std::span<const LeaderboardEntry> entries = getEntries(mode);
+    return entries.empty() ? 0 : entries[0].score;
+}
+
+std::span<const LeaderboardEntry> HighscoreManager::getEntries(std::string_view mode) const {
+    int index = findBoard(table, mode.substr(0, MAX_MODE_NAME));
+    if (index < 0) return {};
+
+    const ModeBoard &board = table.boards[index];
+    return std::span<const LeaderboardEntry>(board.entries, static_cast<size_t>(board.count));
+}
+
+int HighscoreManager::submit(std::string_view mode, const LeaderboardEntry &entry) {
+    int rank = insert(table, mode, entry);
+    if (rank >= 0) queueSave(mode, entry);
+    return rank;
+}
+
+void HighscoreManager::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&] { return pending.empty() && !writing; });
+}
+
+void HighscoreManager::queueSave(std::string_view mode, const LeaderboardEntry &entry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.emplace_back(std::string(mode), entry);
+        latest = table;
+        if (!writer.joinable()) writer = std::thread(&HighscoreManager::writerLoop, this);
+    }
+
+    wake.notify_one();
 }
 
-bool HighscoreManager::saveIfHigher(int score) {
-    if (score <= highscore) return false;
+void HighscoreManager::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    int failures = 0;
+
+    while (true) {
+        wake.wait(lock, [&] { return stopping || !pending.empty(); });
+        if (pending.empty()) return; // stopping with nothing left to save
+
+        std::vector<std::pair<std::string, LeaderboardEntry>> batch;
+        batch.swap(pending);
+        Table known = latest;
+        writing = true;
+        lock.unlock();
+
+        if (!save(batch, known) && ++failures < MAX_SAVE_ATTEMPTS) {
+            // no lock or no readable file right now: back off and try again, ahead of newer entries
+            std::this_thread::sleep_for(SAVE_RETRY_DELAY * (1 << (failures - 1)));
+
+            lock.lock();
+            pending.insert(pending.begin(), batch.begin(), batch.end());
+            writing = false;
+            continue;
+        }
 
-    std::ofstream out(path, std::ios::trunc);
-    if (!out) return false; // failed to open file
+        failures = 0; // saved, or given up: the entries stay on this instance's board either way
 
-    out << score << std::endl;
-    highscore = score;
-    return true;
+        lock.lock();
+        writing = false;
+        if (pending.empty()) idle.notify_all();
+    }
 }
 
+bool HighscoreManager::save(const std::vector<std::pair<std::string, LeaderboardEntry>> &batch, const Table &known) {
+    // other instances may have saved since we loaded: merge into the file as it is now, and never
+    // without the lock, or their entries could be lost
+    std::string lockPath = path + ".lock";
+    std::intptr_t fileLock = platform::lockFile(lockPath.c_str());
+    if (fileLock < 0) return false;
+
+    Table onDisk;
+    ReadResult read = readTable(path, onDisk);
+    bool ok = read != ReadResult::Unreadable;
+
+    if (read == ReadResult::Corrupt) {
+        // keep the damaged file for inspection and rebuild from the boards this instance knows
+        std::string bad = path + ".bad";
+        std::remove(bad.c_str());
+        ok = std::rename(path.c_str(), bad.c_str()) == 0;
+        onDisk = known;
+    }
+
+    if (ok) {
+        for (const auto &[mode, entry] : batch) {
+            // another instance may have migrated the same legacy score already
+            int index = findBoard(onDisk, std::string_view(mode).substr(0, MAX_MODE_NAME));
+            if (index < 0 || !contains(onDisk.boards[index], entry)) insert(onDisk, mode, entry);
+        }
+
+        unsigned char buffer[MAX_FILE_SIZE];
+        ok = platform::writeFileAtomic(path.c_str(), buffer, encode(onDisk, buffer));
+    }
+
+    platform::unlockFile(fileLock);
+    return ok;
+}
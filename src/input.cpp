@@ -0,0 +1,80 @@
+#include "../include/input.hpp"
+#include <algorithm>
+
+namespace {
+    using namespace std::chrono_literals;
+
+    constexpr auto repeatGap = 60ms; // same-key events closer than this are OS auto-repeats, not taps
+    constexpr auto holdWindow = 1000ms; // same-key events within this gap belong to one press for DAS purposes
+    constexpr auto initialReleaseTimeout = 100ms; // used until the OS repeat interval has been observed
+    constexpr auto minReleaseTimeout = 20ms;
+    constexpr auto maxReleaseTimeout = 150ms;
+    constexpr auto instantRecheck = 16ms; // with a 0 ms rate, how often a held key slides again
+
+    bool isRepeatable(int key) {
+        return key == 'a' || key == 'd' || key == 's';
+    }
+}
+
+AutoRepeat::AutoRepeat(const InputConfig &config): config(config), releaseTimeout(initialReleaseTimeout) {}
+
+bool AutoRepeat::onKey(int key, platform::Clock::time_point now) {
+    if (!isRepeatable(key)) return true;
+
+    if (key == held) {
+        auto gap = now - lastEvent;
+        lastEvent = now;
+
+        if (gap <= repeatGap) {
+            if (confirmed) releaseTimeout = std::clamp<platform::Clock::duration>(gap * 3 / 2, minReleaseTimeout, maxReleaseTimeout);
+            else nextRepeat = std::max(now, pressTime + config.das);
+
+            confirmed = true;
+            return false; // absorbed: the schedule decides when the held key steps again
+        }
+
+        if (gap <= holdWindow) {
+            confirmed = false; // a separate tap of the same key: apply it, keep the original press for DAS
+            return true;
+        }
+    }
+
+    held = key;
+    confirmed = false;
+    pressTime = lastEvent = now;
+    releaseTimeout = initialReleaseTimeout;
+    return true;
+}
+
+int AutoRepeat::due(platform::Clock::time_point now) {
+    if (!held || !confirmed) return 0;
+
+    if (now - lastEvent > releaseTimeout) {
+        confirmed = false; // repeats stopped: the key was released
+        return 0;
+    }
+
+    if (now < nextRepeat) return 0;
+
+    auto rate = rateFor(held);
+
+    if (rate.count() == 0) {
+        nextRepeat = now + instantRecheck;
+        return UNLIMITED;
+    }
+
+    int steps = 0;
+    while (nextRepeat <= now) {
+        nextRepeat += rate;
+        ++steps;
+    }
+
+    return steps;
+}
+
+platform::Clock::time_point AutoRepeat::nextDeadline() const {
+    if (!held || !confirmed) return platform::Clock::time_point::max();
+
+    // wake up for the next step, or to notice the release if the repeats stop first
+    return std::min(nextRepeat, lastEvent + releaseTimeout + 1ms);
+}
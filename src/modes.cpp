@@ -1,152 +1,96 @@
 #include "../include/modes.hpp"
-#include "../include/game.hpp"
-#include <memory>
-#include <cstdlib>
-#include <sstream>
+#include "../include/game_state.hpp"
 
-namespace {
-    struct BaseMode : IMode {
-        std::string name() const override { return "Base"; }
-    };
+FunMode::FunMode(const FunModeConfig &config) {
+    Powerup *powerups[4] = { &p1, &p2, &p3, &p4 };
 
-    struct NormalMode : BaseMode {
-        std::string name() const override { return "Normal"; }
-    };
-
-    struct FunMode : BaseMode {
-        struct Powerup {
-            int pointsThreshold = 0; // points needed to unlock
-            int cooldownNeeded = 0; // number of fixed tetrominos needed to cooldown
-            int fixedSinceUse = -1; // -1 means not used / not currently cooling; >=0 counts fixed tetrominos since use
-            bool ready = false;
-        };
-
-        FunMode() {
-            p1.pointsThreshold = 1000; p1.cooldownNeeded = 15; p1.fixedSinceUse = -1; p1.ready = false;
-            p2.pointsThreshold = 2500; p2.cooldownNeeded = 15; p2.fixedSinceUse = -1; p2.ready = false;
-            p3.pointsThreshold = 5000; p3.cooldownNeeded = 15; p3.fixedSinceUse = -1; p3.ready = false;
-            p4.pointsThreshold = 7500; p4.cooldownNeeded = 30; p4.fixedSinceUse = -1; p4.ready = false;
-        }
-
-        std::string name() const override { return "Fun"; }
-
-        void onStart(Game &game) override {
-            checkReadiness(game); // determine initial readiness based on score
-        }
-
-        void onTick(Game &game, int tick) override {
-            (void)tick;
-            (void)game;
-        }
-
-        void onInput(Game &game, int key) override {
-            if (key >= '1' && key <= '4') {
-                int idx = key - '1';
-                attemptActivate(game, idx);
-            }
-        }
-
-        void onLock(Game &game) override {
-            auto inc = [&](Powerup &p) {
-                if (p.fixedSinceUse >= 0) {
-                    p.fixedSinceUse++;
-
-                    // check if cooldown completed
-                    if (p.fixedSinceUse >= p.cooldownNeeded) {
-                        p.ready = true;
-                        p.fixedSinceUse = -1;
-                    }
-                }
-            };
-
-            if (p1.fixedSinceUse >= 0) inc(p1);
-            if (p2.fixedSinceUse >= 0) inc(p2);
-            if (p3.fixedSinceUse >= 0) inc(p3);
-            if (p4.fixedSinceUse >= 0) inc(p4);
+    for (int i = 0; i < 4; ++i) {
+        powerups[i]->pointsThreshold = config.pointsThreshold[i];
+        powerups[i]->cooldownNeeded = config.cooldown[i];
+        powerups[i]->ready = false;
+    }
+}
 
-            checkReadiness(game);
-        }
+// cooldowns expire on the lock clock before this hook runs
+void FunMode::onLock(GameState &game) {
+    checkReadiness(game);
+}
 
-        std::string getSideNote(const Game &game) const override {
-            std::ostringstream ss;
+void FunMode::rebuildNote() {
+    note.clear();
 
-            bool anyReady = p1.ready || p2.ready || p3.ready || p4.ready;
-            if (!anyReady) return std::string();
+    if (p1.ready) note.append("1) Fill bottom hole (press 1)").push_back('\n');
+    if (p2.ready) note.append("2) Skip current piece (press 2)").push_back('\n');
+    if (p3.ready) note.append("3) Slow current piece x3 (press 3)").push_back('\n');
+    if (p4.ready) note.append("4) Remove top 3 rows (press 4)").push_back('\n');
+}
 
-            if (p1.ready) ss << "1) Fill bottom hole (press 1)" << "\n";
-            if (p2.ready) ss << "2) Skip current piece (press 2)" << "\n";
-            if (p3.ready) ss << "3) Slow current piece x3 (press 3)" << "\n";
-            if (p4.ready) ss << "4) Remove top 3 rows (press 4)" << "\n";
+void FunMode::checkReadiness(const GameState &game) {
+    const EffectScheduler &effects = game.getEffects();
 
-            return ss.str();
-        }
+    if (!p1.ready && game.getScore() >= p1.pointsThreshold && !effects.pending(p1.cooldown)) p1.ready = true;
+    if (!p2.ready && game.getScore() >= p2.pointsThreshold && !effects.pending(p2.cooldown)) p2.ready = true;
+    if (!p3.ready && game.getScore() >= p3.pointsThreshold && !effects.pending(p3.cooldown)) p3.ready = true;
+    if (!p4.ready && game.getScore() >= p4.pointsThreshold && !effects.pending(p4.cooldown)) p4.ready = true;
 
-    private:
-        Powerup p1, p2, p3, p4;
+    rebuildNote();
+}
 
-        void checkReadiness(const Game &game) {
-            if (!p1.ready && game.getScore() >= p1.pointsThreshold && p1.fixedSinceUse == -1) p1.ready = true;
-            if (!p2.ready && game.getScore() >= p2.pointsThreshold && p2.fixedSinceUse == -1) p2.ready = true;
-            if (!p3.ready && game.getScore() >= p3.pointsThreshold && p3.fixedSinceUse == -1) p3.ready = true;
-            if (!p4.ready && game.getScore() >= p4.pointsThreshold && p4.fixedSinceUse == -1) p4.ready = true;
-        }
+// ready again once cooldownNeeded more pieces have locked
+EffectHandle FunMode::startCooldown(GameState &game, const Powerup &p) {
+    return game.getEffects().schedule(EffectClock::Lock, static_cast<uint64_t>(game.getPiecesLocked()) + p.cooldownNeeded, EffectKind::Cooldown);
+}
 
-        void attemptActivate(Game &game, int idx) {
-            switch (idx) {
-                case 0:
-                    if (p1.ready) {
-                        game.fillBottomHole();
-                        p1.ready = false;
-                        p1.fixedSinceUse = 0;
-                    }
-                    break;
-                case 1:
-                    if (p2.ready) {
-                        game.skipCurrentPiece();
-                        p2.ready = false;
-                        p2.fixedSinceUse = 0;
-                    }
-                    break;
-                case 2:
-                    if (p3.ready) {
-                        game.applySlowToActivePiece(3);
-                        p3.ready = false;
-                        p3.fixedSinceUse = 0;
-                    }
-                    break;
-                case 3:
-                    if (p4.ready) {
-                        game.deleteTopRows(3);
-                        p4.ready = false;
-                        p4.fixedSinceUse = 0;
-                    }
-                    break;
-                default:
-                    break;
+void FunMode::attemptActivate(GameState &game, int idx) {
+    switch (idx) {
+        case 0:
+            if (p1.ready) {
+                game.fillBottomHole();
+                p1.ready = false;
+                p1.cooldown = startCooldown(game, p1);
             }
-        }
-    };
-
-    struct HardMode : BaseMode {
-        std::string name() const override { return "Hard"; }
+            break;
+        case 1:
+            if (p2.ready) {
+                game.skipCurrentPiece();
+                p2.ready = false;
+                p2.cooldown = startCooldown(game, p2);
+            }
+            break;
+        case 2:
+            if (p3.ready) {
+                game.applySlowToActivePiece(3);
+                p3.ready = false;
+                p3.cooldown = startCooldown(game, p3);
+            }
+            break;
+        case 3:
+            if (p4.ready) {
+                game.deleteTopRows(3);
+                p4.ready = false;
+                p4.cooldown = startCooldown(game, p4);
+            }
+            break;
+        default:
+            break;
+    }
 
-        void onLock(Game &game) override {
-            if (game.getScore() < 500) return; // Negative power-ups start after 500 points
+    rebuildNote();
+}
 
-            // 10% chance to trigger a negative
-            int r = std::rand() % 100;
-            if (r >= 10) return;
+void HardMode::onLock(GameState &game) {
+    if (game.getScore() < config.minScore) return; // Negative power-ups start after 500 points by default
 
-            game.scheduleNextSpeedMultiplier(3);
-        }
-    };
+    // 10% chance (by default) to trigger a negative
+    if (game.modeRandom().below(100) >= static_cast<uint32_t>(config.chancePercent)) return;
 
-    struct MixedMode : BaseMode {
-        std::string name() const override { return "Mixed"; }
-    };
+    game.scheduleNextSpeedMultiplier(config.speedMultiplier);
 }
 
-std::shared_ptr<IMode> createNormalMode() { return std::make_shared<NormalMode>(); }
-std::shared_ptr<IMode> createFunMode() { return std::make_shared<FunMode>(); }
-std::shared_ptr<IMode> createHardMode() { return std::make_shared<HardMode>(); }
-std::shared_ptr<IMode> createMixedMode() { return std::make_shared<MixedMode>(); }
+std::optional<Mode> modeByName(std::string_view name) {
+    if (name == NormalMode::NAME) return NormalMode();
+    if (name == FunMode::NAME) return FunMode();
+    if (name == HardMode::NAME) return HardMode();
+    if (name == MixedMode::NAME) return MixedMode();
+    return std::nullopt;
+}
@@ -0,0 +1,37 @@
+#include "../include/piece_queue.hpp"
+
+PieceQueue::PieceQueue(uint64_t seed, Randomizer randomizer): random(seed), randomizer(randomizer) {
+    while (count + BATCH <= CAPACITY) refill();
+}
+
+uint8_t PieceQueue::pop() {
+    uint8_t type = types[head];
+    head = (head + 1) & (CAPACITY - 1);
+    --count;
+
+    if (count + BATCH <= CAPACITY) refill();
+    return type;
+}
+
+void PieceQueue::refill() {
+    uint8_t batch[BATCH];
+
+    if (randomizer == Randomizer::SevenBag) {
+        // Fisher-Yates shuffle of one of each piece
+        for (int i = 0; i < BATCH; ++i) batch[i] = static_cast<uint8_t>(i);
+
+        for (int i = BATCH - 1; i > 0; --i) {
+            int j = static_cast<int>(random.below(static_cast<uint32_t>(i + 1)));
+            uint8_t t = batch[i];
+            batch[i] = batch[j];
+            batch[j] = t;
+        }
+    } else {
+        for (auto &type : batch) type = static_cast<uint8_t>(random.below(TETROMINO_TYPES));
+    }
+
+    for (uint8_t type : batch) {
+        types[(head + count) & (CAPACITY - 1)] = type;
+        ++count;
+    }
+}
@@ -0,0 +1,249 @@
+#include "../include/placement.hpp"
+#include <bit>
+#include <cstring>
+
+namespace {
+    constexpr uint16_t X_MASK = (1u << PlacementFinder::X_POSITIONS) - 1;
+
+    // Rotations that cover the same cells up to a shift share a canonical rotation; a piece at
+    // (x, y) in rotation r covers the same cells as the canonical rotation at (x + dx, y + dy).
+    struct Canonical {
+        uint8_t rotation;
+        int8_t dx;
+        int8_t dy;
+    };
+
+    struct CanonicalTable {
+        Canonical entries[TETROMINO_TYPES][TETROMINO_ROTATIONS];
+    };
+
+    constexpr int topRow(const PieceShape &s) {
+        int i = 0;
+        while (i < 3 && s.rows[i] == 0) ++i;
+        return i;
+    }
+
+    constexpr int leftColumn(const PieceShape &s) {
+        uint16_t all = s.rows[0] | s.rows[1] | s.rows[2] | s.rows[3];
+        int j = 0;
+        while (j < 3 && !(all & (1u << j))) ++j;
+        return j;
+    }
+
+    constexpr bool sameCells(const PieceShape &a, const PieceShape &b) {
+        int ta = topRow(a), tb = topRow(b), la = leftColumn(a), lb = leftColumn(b);
+
+        for (int i = 0; i < 4; ++i) {
+            uint16_t ra = (ta + i < 4) ? static_cast<uint16_t>(a.rows[ta + i] >> la) : 0;
+            uint16_t rb = (tb + i < 4) ? static_cast<uint16_t>(b.rows[tb + i] >> lb) : 0;
+            if (ra != rb) return false;
+        }
+
+        return true;
+    }
+
+    constexpr CanonicalTable buildCanonical() {
+        CanonicalTable table{};
+
+        for (int type = 0; type < TETROMINO_TYPES; ++type) {
+            for (int r = 0; r < TETROMINO_ROTATIONS; ++r) {
+                const PieceShape &shape = PIECE_SHAPES.shapes[type][r];
+                int c = 0;
+                while (!sameCells(PIECE_SHAPES.shapes[type][c], shape)) ++c;
+
+                const PieceShape &canonical = PIECE_SHAPES.shapes[type][c];
+                table.entries[type][r] = {
+                    static_cast<uint8_t>(c),
+                    static_cast<int8_t>(leftColumn(shape) - leftColumn(canonical)),
+                    static_cast<int8_t>(topRow(shape) - topRow(canonical))
+                };
+            }
+        }
+
+        return table;
+    }
+
+    constexpr CanonicalTable CANONICAL = buildCanonical();
+
+    static_assert(CANONICAL.entries[1][3].rotation == 0, "all O rotations cover the same cells");
+    static_assert(PlacementFinder::MAX_STATES <= 0xFFFF, "states are stored as uint16_t");
+}
+
+std::span<const Placement> PlacementFinder::find(const Board &board, const Tetromino &piece) {
+    type = piece.type;
+
+    // fits[r][y] bit x+3: every cell of the piece is free. A cell c columns right of x is free when
+    // bit x+3+c of the inverted row is set, so shifting the inverted row right by c aligns it on x.
+    for (int r = 0; r < TETROMINO_ROTATIONS; ++r) {
+        const PieceShape &shape = PIECE_SHAPES.shapes[type][r];
+
+        for (int y = 0; y < BOARD_HEIGHT; ++y) {
+            uint16_t ok = X_MASK;
+
+            for (int i = 0; i < 4 && ok; ++i) {
+                if (shape.rows[i] == 0) continue;
+                if (y + i >= BOARD_HEIGHT) {
+                    ok = 0;
+                    break;
+                }
+
+                uint16_t free = static_cast<uint16_t>(~board.rows[y + i]);
+                for (uint16_t cells = shape.rows[i]; cells; cells &= cells - 1)
+                    ok &= static_cast<uint16_t>(free >> std::countr_zero(cells));
+            }
+
+            fits[r][y] = ok;
+        }
+
+        fits[r][BOARD_HEIGHT] = 0;
+    }
+
+    int xb = piece.x + BOARD_WALL_BITS;
+    if (piece.y < 0 || piece.y >= BOARD_HEIGHT || xb < 0 || xb >= X_POSITIONS) return {};
+    if (!(fits[piece.rotation][piece.y] & (1u << xb))) return {};
+
+    std::memset(reached, 0, sizeof(reached));
+    std::memset(pending, 0, sizeof(pending));
+    std::memset(covered, 0, sizeof(covered));
+
+    int count = 0, rows = 0, depth = 0;
+
+    layers[rows++] = { piece.rotation, static_cast<uint8_t>(piece.y), static_cast<uint16_t>(1u << xb) };
+    reached[piece.rotation][piece.y] = static_cast<uint16_t>(1u << xb);
+    layerStart[0] = 0;
+    layerStart[1] = static_cast<uint16_t>(rows);
+
+    const KickOffset (&kicks)[TETROMINO_ROTATIONS][KICK_TESTS] = PIECE_KICKS.kicks[type];
+
+    while (layerStart[depth] < layerStart[depth + 1]) {
+        int touchedCount = 0;
+
+        auto add = [&](int r, int y, uint16_t xs) {
+            xs &= static_cast<uint16_t>(~reached[r][y]);
+            if (!xs) return;
+
+            if (!pending[r][y]) touched[touchedCount++] = static_cast<uint16_t>(r * BOARD_HEIGHT + y);
+            pending[r][y] |= xs;
+        };
+
+        for (int i = layerStart[depth]; i < layerStart[depth + 1]; ++i) {
+            const int r = layers[i].rotation, y = layers[i].y;
+            const uint16_t xs = layers[i].xs;
+
+            // Hard drops. A state right below a reached one lands in the same spot no cheaper, so only
+            // the top of each column run needs dropping; BFS order makes the first drop onto a footprint
+            // the cheapest.
+            uint16_t falling = y > 0 ? static_cast<uint16_t>(xs & ~reached[r][y - 1]) : xs;
+            const Canonical &c = CANONICAL.entries[type][r];
+
+            for (int row = y; falling; ++row) {
+                uint16_t landed = falling & static_cast<uint16_t>(~fits[r][row + 1]);
+                falling &= fits[r][row + 1];
+
+                for (; landed; landed &= landed - 1) {
+                    int x = std::countr_zero(landed);
+                    uint32_t &slot = covered[c.rotation][row + c.dy + 4];
+                    uint32_t footprint = 1u << (x + c.dx + 4);
+                    if (slot & footprint) continue;
+
+                    slot |= footprint;
+                    Tetromino p{ type, static_cast<uint8_t>(r), static_cast<int8_t>(x - BOARD_WALL_BITS), static_cast<int8_t>(row) };
+                    results[count++] = { p, static_cast<uint16_t>(depth + 1), static_cast<uint8_t>(r), static_cast<int8_t>(x), static_cast<int8_t>(y) };
+                }
+            }
+
+            add(r, y, static_cast<uint16_t>((xs >> 1) & fits[r][y])); // 'a'
+            add(r, y, static_cast<uint16_t>((xs << 1) & fits[r][y])); // 'd'
+            if (y + 1 < BOARD_HEIGHT) add(r, y + 1, xs & fits[r][y + 1]); // 's'
+
+            // 'w': like rotateWithKicks, each column takes the first kick that fits
+            int target = (r + 1) & 3;
+            uint16_t rotating = xs;
+
+            for (int k = 0; k < KICK_TESTS && rotating; ++k) {
+                int dx = kicks[r][k].dx, ky = y + kicks[r][k].dy;
+                if (ky < 0 || ky >= BOARD_HEIGHT) continue;
+
+                // bit x set when the piece fits at x + dx in the target rotation
+                uint16_t fitsKicked = static_cast<uint16_t>(dx >= 0 ? fits[target][ky] >> dx : fits[target][ky] << -dx);
+                uint16_t kicked = rotating & fitsKicked;
+                rotating &= static_cast<uint16_t>(~kicked);
+
+                add(target, ky, static_cast<uint16_t>(dx >= 0 ? kicked << dx : kicked >> -dx));
+            }
+        }
+
+        // the built layer becomes the next frontier
+        for (int t = 0; t < touchedCount; ++t) {
+            int r = touched[t] / BOARD_HEIGHT, y = touched[t] % BOARD_HEIGHT;
+
+            layers[rows++] = { static_cast<uint8_t>(r), static_cast<uint8_t>(y), pending[r][y] };
+            reached[r][y] |= pending[r][y];
+            pending[r][y] = 0;
+        }
+
+        ++depth;
+        layerStart[depth + 1] = static_cast<uint16_t>(rows);
+    }
+
+    return std::span<const Placement>(results, count);
+}
+
+bool PlacementFinder::inLayer(int d, int r, int y, int xb) const {
+    if (y < 0 || y >= BOARD_HEIGHT || xb < 0 || xb >= X_POSITIONS) return false;
+
+    for (int i = layerStart[d]; i < layerStart[d + 1]; ++i)
+        if (layers[i].rotation == r && layers[i].y == y) return (layers[i].xs >> xb) & 1;
+
+    return false;
+}
+
+bool PlacementFinder::kickLands(int r, int y, int xb, int kick) const {
+    const KickOffset *kicks = PIECE_KICKS.kicks[type][r];
+    int target = (r + 1) & 3;
+
+    for (int k = 0; k < kick; ++k) {
+        int kx = xb + kicks[k].dx, ky = y + kicks[k].dy;
+        if (kx >= 0 && kx < X_POSITIONS && ky >= 0 && ky < BOARD_HEIGHT && (fits[target][ky] & (1u << kx))) return false;
+    }
+
+    return true;
+}
+
+int PlacementFinder::path(const Placement &p, int *keys) const {
+    int n = p.inputs - 1;
+    keys[n] = ' ';
+
+    // walk back one layer at a time to any state that leads here with one key
+    int r = p.rotation, y = p.y, x = p.x;
+
+    for (int d = n; d > 0; --d) {
+        if (inLayer(d - 1, r, y - 1, x)) {
+            keys[d - 1] = 's';
+            --y;
+        } else if (inLayer(d - 1, r, y, x + 1)) {
+            keys[d - 1] = 'a';
+            ++x;
+        } else if (inLayer(d - 1, r, y, x - 1)) {
+            keys[d - 1] = 'd';
+            --x;
+        } else {
+            int from = (r + 3) & 3;
+            const KickOffset *kicks = PIECE_KICKS.kicks[type][from];
+
+            for (int k = 0; k < KICK_TESTS; ++k) {
+                int px = x - kicks[k].dx, py = y - kicks[k].dy;
+                if (inLayer(d - 1, from, py, px) && kickLands(from, py, px, k)) {
+                    r = from;
+                    x = px;
+                    y = py;
+                    break;
+                }
+            }
+
+            keys[d - 1] = 'w';
+        }
+    }
+
+    return n + 1;
+}
@@ -0,0 +1,279 @@
+#include "../include/platform.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <termios.h>
+#include <unistd.h>
+
+static termios originalTermios;
+static termios rawTermios;
+static bool rawModeActive = false;
+static volatile sig_atomic_t resized = 0;
+static bool inputClosed = false; // stdin hit EOF or hung up; waits then just sleep until their deadline
+
+// bytes read from stdin but not yet returned by getch (escape sequences arrive in one read)
+static unsigned char inputBuffer[64];
+static int inputStart = 0;
+static int inputEnd = 0;
+
+namespace {
+    constexpr int escapeTimeoutMs = 25; // a lone ESC is reported if no sequence bytes follow within this time
+
+    void restoreTerminal() {
+        if (rawModeActive) tcsetattr(STDIN_FILENO, TCSAFLUSH, &originalTermios);
+
+        const char showCursor[] = "\033[?25h";
+        ssize_t ignored = ::write(STDOUT_FILENO, showCursor, sizeof(showCursor) - 1);
+        (void)ignored;
+    }
+
+    void onTerminatingSignal(int sig) {
+        // only async-signal-safe calls here: put the terminal back, then die with the original signal
+        restoreTerminal();
+        signal(sig, SIG_DFL);
+        raise(sig);
+    }
+
+    void onResize(int) {
+        resized = 1;
+    }
+
+    void onSuspend(int) {
+        // Ctrl+Z: hand the shell a sane terminal, then stop for real. The default action runs once the
+        // handler unblocks SIGTSTP and carries on from here after SIGCONT.
+        int savedErrno = errno;
+        restoreTerminal();
+
+        signal(SIGTSTP, SIG_DFL);
+        sigset_t tstp;
+        sigemptyset(&tstp);
+        sigaddset(&tstp, SIGTSTP);
+        sigprocmask(SIG_UNBLOCK, &tstp, nullptr);
+        raise(SIGTSTP);
+
+        struct sigaction sa{};
+        sa.sa_handler = onSuspend;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGTSTP, &sa, nullptr);
+        errno = savedErrno;
+    }
+
+    void onContinue(int) {
+        // back in the foreground (after Ctrl+Z or an external SIGSTOP): raw mode again and a full redraw
+        int savedErrno = errno;
+
+        if (rawModeActive && tcgetpgrp(STDIN_FILENO) == getpgrp()) {
+            tcsetattr(STDIN_FILENO, TCSAFLUSH, &rawTermios);
+
+            const char hideCursor[] = "\033[?25l";
+            ssize_t ignored = ::write(STDOUT_FILENO, hideCursor, sizeof(hideCursor) - 1);
+            (void)ignored;
+        }
+
+        resized = 1;
+        errno = savedErrno;
+    }
+
+    bool fillBuffer(int timeoutMs) {
+        if (inputStart < inputEnd) return true;
+        if (inputClosed) return false;
+
+        pollfd pfd{STDIN_FILENO, POLLIN, 0};
+        if (poll(&pfd, 1, timeoutMs) <= 0) return false;
+
+        ssize_t n = read(STDIN_FILENO, inputBuffer, sizeof(inputBuffer));
+        if (n <= 0) {
+            if (n == 0 || errno != EINTR) inputClosed = true;
+            return false;
+        }
+
+        inputStart = 0;
+        inputEnd = static_cast<int>(n);
+        return true;
+    }
+
+    int nextByte(int timeoutMs) {
+        if (!fillBuffer(timeoutMs)) return -1;
+        return inputBuffer[inputStart++];
+    }
+
+    // Translates "ESC [ x" / "ESC O x" into KEY_* codes; unknown sequences are consumed and reported as ESC.
+    int parseEscape() {
+        int intro = nextByte(escapeTimeoutMs);
+        if (intro != '[' && intro != 'O') {
+            if (intro >= 0) --inputStart; // not a sequence: leave the byte for the next getch
+            return 27;
+        }
+
+        int c = nextByte(escapeTimeoutMs);
+
+        // skip parameters such as "1;5" in modified arrow keys
+        while (c >= '0' && c <= ';') c = nextByte(escapeTimeoutMs);
+
+        switch (c) {
+            case 'A': return platform::KEY_UP;
+            case 'B': return platform::KEY_DOWN;
+            case 'C': return platform::KEY_RIGHT;
+            case 'D': return platform::KEY_LEFT;
+            default: return 27;
+        }
+    }
+}
+
+namespace platform {
+
+    void init() {
+        if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &originalTermios) == 0) {
+            // raw-ish mode: no line buffering or echo, but keep ISIG so Ctrl+C still reaches our handler
+            rawTermios = originalTermios;
+            rawTermios.c_lflag &= ~(ICANON | ECHO);
+            rawTermios.c_iflag &= ~(IXON | ICRNL);
+            rawTermios.c_cc[VMIN] = 1;
+            rawTermios.c_cc[VTIME] = 0;
+
+            if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &rawTermios) == 0) rawModeActive = true;
+        }
+
+        struct sigaction sa{};
+        sa.sa_handler = onTerminatingSignal;
+        sigemptyset(&sa.sa_mask);
+        for (int sig : { SIGINT, SIGTERM, SIGHUP, SIGQUIT }) sigaction(sig, &sa, nullptr);
+
+        // no SA_RESTART: a resize interrupts poll() so waiting callers can redraw right away
+        struct sigaction winch{};
+        winch.sa_handler = onResize;
+        sigemptyset(&winch.sa_mask);
+        sigaction(SIGWINCH, &winch, nullptr);
+
+        struct sigaction tstp{};
+        tstp.sa_handler = onSuspend;
+        sigemptyset(&tstp.sa_mask);
+        sigaction(SIGTSTP, &tstp, nullptr);
+
+        // a continue is reported like a resize, which makes the game repaint everything
+        struct sigaction cont{};
+        cont.sa_handler = onContinue;
+        sigemptyset(&cont.sa_mask);
+        sigaction(SIGCONT, &cont, nullptr);
+    }
+
+    void restore() {
+        restoreTerminal();
+        rawModeActive = false;
+
+        for (int sig : { SIGINT, SIGTERM, SIGHUP, SIGQUIT, SIGWINCH, SIGTSTP, SIGCONT }) signal(sig, SIG_DFL);
+    }
+
+    bool kbhit() {
+        return fillBuffer(0);
+    }
+
+    int getch() {
+        int c = nextByte(-1);
+        if (c < 0) return 0;
+        if (c == 27) return parseEscape();
+
+        return c;
+    }
+
+    bool waitForInput(Clock::time_point deadline) {
+        while (true) {
+            if (inputStart < inputEnd) return true;
+            if (resized) return false;
+
+            auto now = Clock::now();
+            if (now >= deadline) return false;
+
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+            pollfd pfd{STDIN_FILENO, static_cast<short>(inputClosed ? 0 : POLLIN), 0};
+            int r = poll(inputClosed ? nullptr : &pfd, inputClosed ? 0 : 1, static_cast<int>(std::min<long long>(remaining.count(), 60000)));
+
+            if (r > 0) {
+                if (fillBuffer(0)) return true;
+                if (pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) inputClosed = true;
+            }
+        }
+    }
+
+    bool waitForInput() {
+        while (true) {
+            if (waitForInput(Clock::now() + std::chrono::hours(1))) return true;
+            if (resized) return false;
+        }
+    }
+
+    bool consumeResize() {
+        bool r = resized != 0;
+        resized = 0;
+        return r;
+    }
+
+    void write(const char *data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(STDOUT_FILENO, data, size);
+
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    std::intptr_t lockFile(const char *path) {
+        int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return -1;
+
+        while (flock(fd, LOCK_EX) != 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    void unlockFile(std::intptr_t handle) {
+        if (handle < 0) return;
+
+        int fd = static_cast<int>(handle);
+        flock(fd, LOCK_UN);
+        ::close(fd);
+    }
+
+    bool writeFileAtomic(const char *path, const void *data, size_t size) {
+        std::string temp = std::string(path) + ".tmp";
+
+        int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+
+        const char *bytes = static_cast<const char *>(data);
+        bool ok = true;
+
+        while (ok && size > 0) {
+            ssize_t n = ::write(fd, bytes, size);
+
+            if (n < 0) {
+                ok = (errno == EINTR);
+                continue;
+            }
+
+            bytes += n;
+            size -= static_cast<size_t>(n);
+        }
+
+        ok = ok && fsync(fd) == 0;
+        ok = (::close(fd) == 0) && ok;
+        ok = ok && std::rename(temp.c_str(), path) == 0;
+
+        if (!ok) ::unlink(temp.c_str());
+        return ok;
+    }
+}
@@ -0,0 +1,158 @@
+#include "../include/platform.hpp"
+#include <windows.h>
+#include <conio.h>
+#include <string>
+
+static DWORD originalMode = 0;
+static DWORD originalInputMode = 0;
+static bool resized = false;
+static UINT originalCPOut = 0;
+static UINT originalCPIn = 0;
+
+namespace platform {
+
+    void init() {
+        // store and set UTF-8
+        originalCPOut = GetConsoleOutputCP();
+        originalCPIn = GetConsoleCP();
+        SetConsoleOutputCP(CP_UTF8);
+        SetConsoleCP(CP_UTF8);
+
+        // enable ANSI escape processing
+        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD dwMode = 0;
+
+        if (GetConsoleMode(hOut, &dwMode)) {
+            originalMode = dwMode;
+            dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+            SetConsoleMode(hOut, dwMode);
+        }
+
+        // deliver window size events so the renderer can redraw after a resize
+        HANDLE hIn = GetStdHandle(STD_INPUT_HANDLE);
+        if (GetConsoleMode(hIn, &dwMode)) {
+            originalInputMode = dwMode;
+            SetConsoleMode(hIn, dwMode | ENABLE_WINDOW_INPUT);
+        }
+    }
+
+    void restore() {
+        // restore code pages
+        SetConsoleOutputCP(originalCPOut);
+        SetConsoleCP(originalCPIn);
+
+        // restore console mode
+        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+        SetConsoleMode(hOut, originalMode);
+        SetConsoleMode(GetStdHandle(STD_INPUT_HANDLE), originalInputMode);
+    }
+
+    bool kbhit() {
+        return _kbhit() != 0;
+    }
+
+    int getch() {
+        int c = _getch();
+        if (c != 0 && c != 224) return c;
+
+        // extended keys arrive as a 0/224 prefix followed by a scan code
+        switch (_getch()) {
+            case 72: return KEY_UP;
+            case 80: return KEY_DOWN;
+            case 75: return KEY_LEFT;
+            case 77: return KEY_RIGHT;
+            default: return 0;
+        }
+    }
+
+    bool waitForInput(Clock::time_point deadline) {
+        HANDLE hIn = GetStdHandle(STD_INPUT_HANDLE);
+
+        while (true) {
+            if (_kbhit()) return true;
+
+            auto now = Clock::now();
+            if (now >= deadline) return false;
+
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+            if (WaitForSingleObject(hIn, static_cast<DWORD>(remaining.count())) != WAIT_OBJECT_0) continue;
+
+            // the handle is also signalled by focus, mouse, resize and key-up events that _kbhit ignores;
+            // drop them so the next wait blocks instead of spinning
+            DWORD pending = 0;
+            if (!_kbhit() && GetNumberOfConsoleInputEvents(hIn, &pending) && pending > 0) {
+                INPUT_RECORD records[32];
+                DWORD read = 0;
+                ReadConsoleInput(hIn, records, pending < 32 ? pending : 32, &read);
+
+                for (DWORD i = 0; i < read; ++i)
+                    if (records[i].EventType == WINDOW_BUFFER_SIZE_EVENT) resized = true;
+            }
+
+            if (resized) return false;
+        }
+    }
+
+    bool waitForInput() {
+        while (true) {
+            if (waitForInput(Clock::now() + std::chrono::hours(1))) return true;
+            if (resized) return false;
+        }
+    }
+
+    bool consumeResize() {
+        bool r = resized;
+        resized = false;
+        return r;
+    }
+
+    void write(const char *data, size_t size) {
+        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+
+        while (size > 0) {
+            DWORD written = 0;
+            if (!WriteFile(hOut, data, static_cast<DWORD>(size), &written, nullptr) || written == 0) return;
+
+            data += written;
+            size -= written;
+        }
+    }
+
+    std::intptr_t lockFile(const char *path) {
+        HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return -1;
+
+        OVERLAPPED whole{};
+        if (!LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &whole)) {
+            CloseHandle(file);
+            return -1;
+        }
+
+        return reinterpret_cast<std::intptr_t>(file);
+    }
+
+    void unlockFile(std::intptr_t handle) {
+        if (handle == -1) return;
+
+        HANDLE file = reinterpret_cast<HANDLE>(handle);
+        OVERLAPPED whole{};
+        UnlockFileEx(file, 0, MAXDWORD, MAXDWORD, &whole);
+        CloseHandle(file);
+    }
+
+    bool writeFileAtomic(const char *path, const void *data, size_t size) {
+        std::string temp = std::string(path) + ".tmp";
+
+        HANDLE file = CreateFileA(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        DWORD written = 0;
+        bool ok = WriteFile(file, data, static_cast<DWORD>(size), &written, nullptr) && written == size;
+        ok = ok && FlushFileBuffers(file);
+        ok = CloseHandle(file) && ok;
+        ok = ok && MoveFileExA(temp.c_str(), path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+
+        if (!ok) DeleteFileA(temp.c_str());
+        return ok;
+    }
+}
@@ -0,0 +1,128 @@
+#include "../include/renderer.hpp"
+#include "../include/platform.hpp"
+#include <charconv>
+
+namespace {
+    // Decodes one UTF-8 sequence starting at s[i] and advances i past it.
+    char32_t decodeUtf8(std::string_view s, size_t &i) {
+        unsigned char c = static_cast<unsigned char>(s[i++]);
+        if (c < 0x80) return c;
+
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : 1;
+        char32_t cp = c & (0x3F >> extra);
+
+        for (int k = 0; k < extra && i < s.size(); ++k)
+            cp = (cp << 6) | (static_cast<unsigned char>(s[i++]) & 0x3F);
+
+        return cp;
+    }
+
+    void appendUtf8(std::string &out, char32_t cp) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    void appendNumber(std::string &out, int value) {
+        char digits[12];
+        auto res = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, res.ptr);
+    }
+
+    constexpr int maxSkipGap = 4; // unchanged cells bridged by plain glyphs instead of a cursor move
+
+    // CSI row;col H with 1-based coordinates
+    void appendCursorMove(std::string &out, int row, int col) {
+        out += "\033[";
+        appendNumber(out, row + 1);
+        out.push_back(';');
+        appendNumber(out, col + 1);
+        out.push_back('H');
+    }
+}
+
+Renderer::Renderer() {
+    // worst case: every cell needs its own cursor move and a 4-byte glyph
+    out.reserve(static_cast<size_t>(SCREEN_ROWS) * SCREEN_COLS * 16);
+    invalidate();
+    clear();
+}
+
+void Renderer::clear() {
+    for (auto &row : back)
+        for (auto &cell : row) cell = U' ';
+}
+
+void Renderer::put(int row, int col, char32_t glyph) {
+    if (row < 0 || row >= SCREEN_ROWS || col < 0 || col >= SCREEN_COLS) return;
+    back[row][col] = glyph;
+}
+
+int Renderer::text(int row, int col, std::string_view utf8) {
+    int written = 0;
+    size_t i = 0;
+
+    while (i < utf8.size()) {
+        put(row, col + written, decodeUtf8(utf8, i));
+        ++written;
+    }
+
+    return written;
+}
+
+void Renderer::invalidate() {
+    for (auto &row : front)
+        for (auto &cell : row) cell = U' ';
+
+    clearPending = true;
+}
+
+bool Renderer::present() {
+    out.clear();
+
+    if (clearPending) {
+        out += "\033[2J";
+        clearPending = false;
+    }
+
+    int cursorRow = -1;
+    int cursorCol = -1;
+
+    for (int y = 0; y < SCREEN_ROWS; ++y) {
+        for (int x = 0; x < SCREEN_COLS; ++x) {
+            char32_t glyph = back[y][x];
+            if (glyph != U' ' && y >= usedRows) usedRows = y + 1;
+            if (glyph == front[y][x]) continue;
+
+            if (y == cursorRow && x > cursorCol && x - cursorCol <= maxSkipGap) {
+                // re-emitting a few unchanged cells is cheaper than a cursor move sequence
+                for (int gx = cursorCol; gx < x; ++gx) appendUtf8(out, back[y][gx]);
+            } else if (y != cursorRow || x != cursorCol) {
+                appendCursorMove(out, y, x);
+            }
+
+            appendUtf8(out, glyph);
+            front[y][x] = glyph;
+            cursorRow = y;
+            cursorCol = x + 1;
+        }
+    }
+
+    if (out.empty()) return false;
+
+    appendCursorMove(out, usedRows, 0); // park the cursor below the frame for any plain text that follows
+    platform::write(out.data(), out.size());
+    return true;
+}
@@ -0,0 +1,145 @@
+#include "../include/replay.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+
+namespace {
+    constexpr char magic[4] = { 'A', 'T', 'R', 'P' };
+    constexpr uint8_t version = 1;
+}
+
+bool ReplayWriter::open(const std::string &path, uint64_t seed, Randomizer randomizer, std::string_view modeName) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    used = 0;
+    lastTick = 0;
+
+    for (char c : magic) buffer[used++] = static_cast<uint8_t>(c);
+    buffer[used++] = version;
+    buffer[used++] = static_cast<uint8_t>(randomizer);
+    for (int i = 0; i < 8; ++i) buffer[used++] = static_cast<uint8_t>(seed >> (8 * i));
+
+    if (modeName.size() > 255) modeName = modeName.substr(0, 255);
+    buffer[used++] = static_cast<uint8_t>(modeName.size());
+    std::memcpy(buffer + used, modeName.data(), modeName.size());
+    used += modeName.size();
+
+    return true;
+}
+
+void ReplayWriter::record(int tick, int key) {
+    if (!out.is_open()) return;
+
+    if (used > sizeof(buffer) - 10) flush(); // room for two worst-case varints
+    putVarint(static_cast<uint32_t>(tick - lastTick));
+    putVarint(static_cast<uint32_t>(key + 1));
+    lastTick = tick;
+}
+
+void ReplayWriter::finish(int finalTick) {
+    if (!out.is_open()) return;
+
+    if (used > sizeof(buffer) - 10) flush();
+    putVarint(static_cast<uint32_t>(finalTick - lastTick));
+    putVarint(0);
+    lastTick = finalTick;
+
+    flush();
+    out.close();
+}
+
+void ReplayWriter::putVarint(uint32_t value) {
+    // LEB128: seven bits per byte, high bit set on all but the last byte
+    while (value >= 0x80) {
+        buffer[used++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    buffer[used++] = static_cast<uint8_t>(value);
+}
+
+void ReplayWriter::flush() {
+    out.write(reinterpret_cast<const char *>(buffer), static_cast<std::streamsize>(used));
+    out.flush();
+    used = 0;
+}
+
+bool ReplayReader::open(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    const size_t fixedHeader = sizeof(magic) + 2 + 8 + 1;
+    if (data.size() < fixedHeader || std::memcmp(data.data(), magic, sizeof(magic)) != 0) return false;
+    if (data[4] != version || data[5] > static_cast<uint8_t>(Randomizer::SevenBag)) return false;
+
+    randomizer = static_cast<Randomizer>(data[5]);
+    seed = 0;
+    for (int i = 0; i < 8; ++i) seed |= static_cast<uint64_t>(data[6 + i]) << (8 * i);
+
+    size_t nameLength = data[14];
+    if (data.size() < fixedHeader + nameLength) return false;
+    modeName.assign(reinterpret_cast<const char *>(data.data() + fixedHeader), nameLength);
+
+    pos = fixedHeader + nameLength;
+    pending = ReplayEvent();
+    ended = false;
+    decodeNext();
+    return true;
+}
+
+ReplayEvent ReplayReader::take() {
+    ReplayEvent e = pending;
+    decodeNext();
+    return e;
+}
+
+bool ReplayReader::getVarint(uint32_t &value) {
+    value = 0;
+
+    for (int shift = 0; shift < 35 && pos < data.size(); shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+
+    return false;
+}
+
+void ReplayReader::decodeNext() {
+    uint32_t delta = 0, key = 0;
+
+    // a truncated file ends the recording after the last complete event
+    if (!getVarint(delta) || !getVarint(key)) {
+        ended = true;
+        return;
+    }
+
+    pending.tick += static_cast<int>(delta);
+    pending.key = static_cast<int>(key) - 1;
+    ended = (key == 0);
+}
+
+void replayHeadless(GameState &state, ReplayReader &reader) {
+    state.start();
+
+    while (!state.isGameOver() && !reader.finished(state.getTick())) {
+        while (reader.hasEventAt(state.getTick())) state.applyInput(reader.take().key);
+
+        state.advanceTick();
+        state.takeEvents();
+    }
+}
+
+uint64_t newReplayId() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+std::string replayPathFor(uint64_t id) {
+    std::error_code ec;
+    std::filesystem::create_directories("replays", ec);
+
+    return "replays/game-" + std::to_string(id) + ".replay";
+}
@@ -0,0 +1,79 @@
+#include "../include/telemetry.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+
+int DurationHistogram::bucketOf(uint64_t us) {
+    if (us < LINEAR) return static_cast<int>(us);
+
+    int log2 = std::bit_width(us) - 1; // >= 6
+    int octave = log2 - 6;
+    if (octave >= OCTAVES) return BUCKETS - 1;
+
+    int sub = static_cast<int>((us >> (log2 - SUB_BITS)) & ((1 << SUB_BITS) - 1));
+    return LINEAR + (octave << SUB_BITS) + sub;
+}
+
+uint64_t DurationHistogram::upperEdge(int bucket) {
+    if (bucket < LINEAR) return static_cast<uint64_t>(bucket);
+
+    int octave = (bucket - LINEAR) >> SUB_BITS;
+    int sub = (bucket - LINEAR) & ((1 << SUB_BITS) - 1);
+    int shift = octave + 6 - SUB_BITS;
+    return ((static_cast<uint64_t>((1 << SUB_BITS) + sub + 1)) << shift) - 1;
+}
+
+void DurationHistogram::add(platform::Clock::duration d) {
+    long long us = std::max<long long>(0, std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+
+    ++buckets[bucketOf(static_cast<uint64_t>(us))];
+    ++total;
+    largest = std::max(largest, us);
+}
+
+long long DurationHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+
+    long long rank = std::max(1LL, static_cast<long long>(p * total + 0.999999)); // 1-based rank of the quantile
+    long long seen = 0;
+
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += buckets[b];
+        if (seen >= rank) return std::min<long long>(static_cast<long long>(upperEdge(b)), largest);
+    }
+
+    return largest;
+}
+
+bool appendTelemetry(const std::string &path, const GameState &state, const SessionTelemetry &session, platform::Clock::time_point ended) {
+    std::FILE *f = std::fopen(path.c_str(), "a");
+    if (!f) return false;
+
+    double seconds = std::chrono::duration<double>(ended - session.started).count();
+    const EffectCounts &effects = state.getEffectCounts();
+    long long timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // mode names are our own identifiers, so they need no escaping
+    std::string_view mode = modeName(state.getMode());
+    std::fprintf(f, "{\"timestamp_ms\":%lld,\"mode\":\"%.*s\",\"seed\":%llu,\"autoplay\":%s,", timestamp,
+                 static_cast<int>(mode.size()), mode.data(), static_cast<unsigned long long>(state.getSeed()), session.autoplay ? "true" : "false");
+
+    std::fprintf(f, "\"duration_s\":%.3f,\"ticks\":%d,\"pieces\":%d,\"pieces_per_s\":%.3f,\"score\":%d,\"level\":%d,\"lines\":%d,",
+                 seconds, state.getTick(), state.getPiecesLocked(), seconds > 0 ? state.getPiecesLocked() / seconds : 0.0, state.getScore(), state.getLevel(), state.getLinesCleared());
+
+    std::fprintf(f, "\"clears\":{\"single\":%d,\"double\":%d,\"triple\":%d,\"tetris\":%d},", state.getClears(1), state.getClears(2), state.getClears(3), state.getClears(4));
+
+    // a slow effect only comes from the slow power-up, so "slow" counts both
+    std::fprintf(f, "\"powerups\":{\"fill\":%d,\"skip\":%d,\"slow\":%d,\"delete\":%d},\"speed_ups\":%d,",
+                 effects.holesFilled, effects.piecesSkipped, effects.slowsApplied, effects.rowDeletes, effects.speedUps);
+
+    auto histogram = [&](const char *name, const DurationHistogram &h, const char *separator) {
+        std::fprintf(f, "\"%s\":{\"count\":%lld,\"p50\":%lld,\"p99\":%lld,\"max\":%lld}%s", name, h.count(), h.percentile(0.5), h.percentile(0.99), h.max(), separator);
+    };
+
+    histogram("frame_us", session.frameTime, ",");
+    histogram("input_latency_us", session.inputLatency, "}\n");
+
+    return std::fclose(f) == 0;
+}
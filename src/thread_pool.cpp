@@ -0,0 +1,87 @@
+#include "../include/thread_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 0; i < threads; ++i) workers.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < threads; ++i) this->threads.emplace_back([this, i] { workerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+    for (auto &t : threads) t.join();
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t, unsigned)> &fn) {
+    if (count == 0) return;
+
+    job = &fn;
+    remaining.store(count);
+
+    size_t n = workers.size();
+    for (size_t w = 0; w < n; ++w) {
+        std::lock_guard<std::mutex> lock(workers[w]->mutex);
+        for (size_t i = w * count / n; i < (w + 1) * count / n; ++i) workers[w]->jobs.push_back(i);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ++generation;
+    wake.notify_all();
+
+    finished.wait(lock, [this] { return remaining.load() == 0; });
+    job = nullptr;
+}
+
+bool WorkStealingPool::take(unsigned id, size_t &index) {
+    {
+        Worker &own = *workers[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+
+        if (!own.jobs.empty()) {
+            index = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t k = 1; k < workers.size(); ++k) {
+        Worker &victim = *workers[(id + k) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (!victim.jobs.empty()) {
+            index = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned id) {
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        size_t index;
+        while (take(id, index)) {
+            (*job)(index, id);
+
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "../include/trace.hpp"
+
+#if defined(TETRIS_TRACE)
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+    struct Event {
+        const char *name;
+        uint64_t begin; // ns
+        uint64_t end;
+        uint32_t thread;
+    };
+
+    Event events[trace::CAPACITY]; // static storage: recording never allocates
+    std::atomic<uint64_t> written{ 0 };
+    std::atomic<uint32_t> threads{ 0 };
+    uint64_t origin = 0;
+
+    uint32_t threadId() {
+        thread_local uint32_t id = threads.fetch_add(1, std::memory_order_relaxed) + 1;
+        return id;
+    }
+
+    // names are literals from our own code, but keep the JSON valid whatever they contain
+    void writeName(std::FILE *f, const char *s) {
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\') std::fputc('\\', f);
+            if (static_cast<unsigned char>(*s) >= 0x20) std::fputc(*s, f);
+        }
+    }
+}
+
+namespace trace {
+    std::atomic<bool> recording{ false };
+
+    uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void record(const char *name, uint64_t begin, uint64_t end) {
+        uint64_t index = written.fetch_add(1, std::memory_order_relaxed);
+        events[index & (CAPACITY - 1)] = { name, begin, end, threadId() };
+    }
+
+    void start() {
+        origin = now();
+        recording.store(true, std::memory_order_relaxed);
+    }
+
+    bool writeChromeJson(const char *path) {
+        recording.store(false, std::memory_order_relaxed);
+
+        std::FILE *f = std::fopen(path, "w");
+        if (!f) return false;
+
+        uint64_t count = written.load(std::memory_order_relaxed);
+        uint64_t first = count > CAPACITY ? count - CAPACITY : 0;
+
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", f);
+
+        for (uint64_t i = first; i < count; ++i) {
+            const Event &e = events[i & (CAPACITY - 1)];
+
+            // complete events ("X") with microsecond timestamps relative to start()
+            std::fputs(i == first ? "{\"name\":\"" : ",\n{\"name\":\"", f);
+            writeName(f, e.name);
+            std::fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", e.thread, (e.begin - origin) / 1000.0, (e.end - e.begin) / 1000.0);
+        }
+
+        std::fputs("\n]}\n", f);
+        return std::fclose(f) == 0;
+    }
+}
+#else
+namespace trace {
+    void start() {}
+    bool writeChromeJson(const char *) { return false; }
+}
+#endif
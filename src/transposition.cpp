@@ -0,0 +1,30 @@
+#include "../include/transposition.hpp"
+#include <bit>
+
+TranspositionCache::TranspositionCache(int log2Entries): entries(new Entry[size_t(1) << log2Entries]), mask((uint64_t(1) << log2Entries) - 1) {}
+
+bool TranspositionCache::probe(uint64_t key, double &value) const {
+    const Entry &e = entries[key & mask];
+    uint64_t check = e.check.load(std::memory_order_relaxed);
+    uint64_t data = e.data.load(std::memory_order_relaxed);
+
+    if ((check ^ data) != key) return false;
+
+    value = std::bit_cast<double>(data);
+    return true;
+}
+
+void TranspositionCache::store(uint64_t key, double value) {
+    Entry &e = entries[key & mask];
+    uint64_t data = std::bit_cast<uint64_t>(value);
+
+    e.check.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionCache::clear() {
+    for (uint64_t i = 0; i <= mask; ++i) {
+        entries[i].check.store(0, std::memory_order_relaxed);
+        entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,98 @@
+// Checks that the steady-state game loop never touches the heap: global operator new/delete are
+// replaced with counting versions, and every tick of every mode (input, gravity, mode hooks,
+// side note, Board::draw and Renderer::present) must leave the counter unchanged.
+
+#include "../include/autoplayer.hpp"
+#include "../include/board.hpp"
+#include "../include/game_state.hpp"
+#include "../include/modes.hpp"
+#include "../include/renderer.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+
+namespace {
+    std::atomic<long> allocations{ 0 };
+
+    void *allocate(std::size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void *p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+}
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr int WARMUP_TICKS = 20; // the first frames fill the renderer's buffers
+    constexpr int MAX_TICKS = 3000;
+    constexpr int MAX_KEYS = 64;
+
+    bool runMode(std::string_view name) {
+        GameState state(1);
+        state.setMode(*modeByName(name));
+        state.start();
+
+        Renderer renderer;
+        AutoPlayer player({}, false); // keeps the game alive long enough to level up and earn power-ups
+        int keys[MAX_KEYS];
+        int worstTick = -1;
+        long worst = 0;
+
+        for (int t = 0; t < MAX_TICKS && !state.isGameOver(); ++t) {
+            // the player is not part of the game loop under test, so its planning is not counted
+            int count = 0;
+            for (auto planned = player.update(state); !planned.empty(); planned = player.update(state))
+                for (int key : planned)
+                    if (count < MAX_KEYS) keys[count++] = key;
+
+            if (t % 8 == 0 && count < MAX_KEYS) keys[count++] = '1' + (t / 8) % 4; // try a power-up now and then
+
+            long before = allocations.load(std::memory_order_relaxed);
+
+            for (int i = 0; i < count; ++i) state.applyInput(keys[i]);
+            state.advanceTick();
+            state.takeEvents();
+
+            renderer.clear();
+            state.getBoard().draw(renderer, state.getCurrent(), state.getScore(), state.getLevel(), 0, state.getSideNote());
+            renderer.present();
+
+            long allocated = allocations.load(std::memory_order_relaxed) - before;
+            if (t >= WARMUP_TICKS && allocated > worst) {
+                worst = allocated;
+                worstTick = t;
+            }
+        }
+
+        if (worst > 0) {
+            std::fprintf(stderr, "%.*s: tick %d allocated %ld times\n", static_cast<int>(name.size()), name.data(), worstTick, worst);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main() {
+    // the frames themselves are not interesting, only what it took to produce them
+#if defined(_WIN32)
+    std::FILE *sink = std::freopen("NUL", "w", stdout);
+#else
+    std::FILE *sink = std::freopen("/dev/null", "w", stdout);
+#endif
+    (void)sink;
+
+    bool ok = true;
+    for (std::string_view name : { "Normal", "Fun", "Hard", "Mixed" }) ok &= runMode(name);
+
+    std::fprintf(stderr, ok ? "no allocations per tick\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
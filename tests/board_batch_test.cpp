@@ -0,0 +1,177 @@
+// Differential test of BoardBatch against Board: drops random pieces on every lane in lockstep
+// through both, and after every step also throws pieces at arbitrary positions at the collide,
+// lock and clear kernels. Boards, hashes, cleared lines and active pieces must match bit for bit.
+
+#include "../include/board.hpp"
+#include "../include/board_batch.hpp"
+#include "../include/random.hpp"
+#include "../include/tetromino.hpp"
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    constexpr uint64_t SEED = 1;
+    constexpr long STEPS = 20000;
+
+    // Drops random pieces on LANES boards in lockstep, once through Board and once through BoardBatch:
+    // each step may move a lane's piece sideways, then moves it down, and a piece that cannot fall is
+    // locked, lines are cleared and a new piece spawns (a lane that tops out starts over with an
+    // empty board). Both sides consume the same random numbers, so their boards must match.
+    class BatchDrop {
+    public:
+        static constexpr int LANES = BoardBatch::LANES;
+
+        explicit BatchDrop(uint64_t seed) : rng(seed) {
+            for (int i = 0; i < LANES; ++i) spawn(i);
+        }
+
+        void stepScalar(Board *boards) {
+            uint64_t r = rng.next();
+
+            for (int i = 0; i < LANES; ++i) {
+                Tetromino moved = pieces[i];
+                if (r >> i & 1) --moved.x;
+                else if (r >> (16 + i) & 1) ++moved.x;
+                if (moved.x != pieces[i].x && !boards[i].collides(moved)) pieces[i] = moved;
+
+                moved = pieces[i];
+                ++moved.y;
+                if (!boards[i].collides(moved)) {
+                    pieces[i] = moved;
+                    continue;
+                }
+
+                boards[i].lockPiece(pieces[i]);
+                cleared[i] += boards[i].clearLines();
+                spawn(i);
+                if (boards[i].collides(pieces[i])) boards[i] = Board();
+            }
+        }
+
+        void stepBatch(BoardBatch &batch) {
+            uint64_t r = rng.next();
+
+            batch.shiftActive(static_cast<uint32_t>(r) & BoardBatch::ALL_LANES, static_cast<uint32_t>(r >> 16) & BoardBatch::ALL_LANES);
+            uint32_t landed = batch.dropActive();
+            if (!landed) return;
+
+            batch.lockActive(landed);
+
+            uint8_t lines[LANES];
+            batch.clearLines(lines);
+
+            for (uint32_t l = landed; l; l &= l - 1) {
+                int i = std::countr_zero(l);
+                cleared[i] += lines[i];
+                spawn(i);
+            }
+
+            uint32_t toppedOut = batch.spawnActive(pieces, landed);
+            if (!toppedOut) return;
+
+            for (uint32_t l = toppedOut; l; l &= l - 1) batch.clearLane(std::countr_zero(l));
+            batch.spawnActive(pieces, toppedOut);
+        }
+
+        long totalCleared() const {
+            long sum = 0;
+            for (int i = 0; i < LANES; ++i) sum += cleared[i];
+            return sum;
+        }
+
+        Tetromino pieces[LANES]; // the batch side only keeps the spawn positions here
+        long cleared[LANES] = {};
+
+    private:
+        Random rng;
+
+        void spawn(int lane) {
+            pieces[lane] = createPiece(static_cast<uint8_t>(rng.below(TETROMINO_TYPES)));
+            pieces[lane].rotation = static_cast<uint8_t>(rng.below(TETROMINO_ROTATIONS));
+            pieces[lane].x = static_cast<int8_t>(rng.below(BOARD_WIDTH - 3));
+        }
+    };
+
+    bool activeMatches(const BoardBatch &batch, int lane, const Tetromino &piece) {
+        const PieceShape &shape = shapeOf(piece);
+
+        for (int y = 0; y < BOARD_HEIGHT; ++y) {
+            int i = y - piece.y;
+            uint16_t expected = (i >= 0 && i < 4) ? static_cast<uint16_t>(shape.rows[i] << (piece.x + BOARD_WALL_BITS)) : 0;
+            if (batch.active[y][lane] != expected) return false;
+        }
+
+        return true;
+    }
+
+    // Also throws pieces at arbitrary positions (partly outside the board, too) at the Tetromino
+    // kernels and compares them with Board on copies of the current boards.
+    bool piecesMatch(const BoardBatch &batch, const Board *boards, Random &rng) {
+        constexpr int LANES = BoardBatch::LANES;
+        Tetromino pieces[LANES];
+
+        for (int i = 0; i < LANES; ++i) {
+            pieces[i] = createPiece(static_cast<uint8_t>(rng.below(TETROMINO_TYPES)));
+            pieces[i].rotation = static_cast<uint8_t>(rng.below(TETROMINO_ROTATIONS));
+            pieces[i].x = static_cast<int8_t>(static_cast<int>(rng.below(BOARD_WIDTH + 6)) - 5);
+            pieces[i].y = static_cast<int8_t>(static_cast<int>(rng.below(BOARD_HEIGHT + 6)) - 4);
+        }
+
+        uint32_t lanes = static_cast<uint32_t>(rng.next()) & BoardBatch::ALL_LANES;
+        uint32_t hit = batch.collides(pieces, lanes);
+
+        BoardBatch locked = batch;
+        locked.lockPieces(pieces, lanes);
+        uint8_t lines[LANES];
+        uint32_t clearing = locked.clearLines(lines);
+
+        for (int i = 0; i < LANES; ++i) {
+            bool selected = lanes >> i & 1;
+            if ((hit >> i & 1) != (selected && boards[i].collides(pieces[i]))) return false;
+
+            Board expected = boards[i];
+            if (selected) expected.lockPiece(pieces[i]);
+            int n = expected.clearLines();
+
+            Board lane = locked.getLane(i);
+            if (lines[i] != n || (clearing >> i & 1) != (n > 0) || lane.getHash() != expected.getHash() || std::memcmp(lane.rows, expected.rows, sizeof(lane.rows)) != 0) return false;
+        }
+
+        return true;
+    }
+
+}
+
+int main() {
+    constexpr int LANES = BatchDrop::LANES;
+
+    BatchDrop scalar(SEED), batched(SEED);
+    Board boards[LANES];
+    BoardBatch batch;
+    batch.spawnActive(batched.pieces, BoardBatch::ALL_LANES);
+    Random probe(SEED, 1);
+
+    for (long s = 0; s < STEPS; ++s) {
+        scalar.stepScalar(boards);
+        batched.stepBatch(batch);
+
+        for (int i = 0; i < LANES; ++i) {
+            Board lane = batch.getLane(i);
+
+            if (std::memcmp(lane.rows, boards[i].rows, sizeof(lane.rows)) != 0 || lane.getHash() != boards[i].getHash() ||
+                scalar.cleared[i] != batched.cleared[i] || !activeMatches(batch, i, scalar.pieces[i])) {
+                std::printf("mismatch in lane %d after step %ld\n", i, s + 1);
+                return 1;
+            }
+        }
+
+        if (!piecesMatch(batch, boards, probe)) {
+            std::printf("piece kernels disagree after step %ld\n", s + 1);
+            return 1;
+        }
+    }
+
+    std::printf("%ld steps x %d lanes match (%s, %ld lines cleared)\n", STEPS, LANES, BoardBatch::kernelName(), scalar.totalCleared());
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Differential test of PlacementFinder against a brute-force BFS over Board::collides and
+// rotateWithKicks: on random boards with overhangs, both must find the same set of resting
+// footprints with the same shortest input counts, no footprint may be reported twice, and every
+// path() must replay with the game's own moves to its placement.
+
+#include "../include/board.hpp"
+#include "../include/placement.hpp"
+#include "../include/random.hpp"
+#include "../include/tetromino.hpp"
+#include <cstdio>
+#include <map>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <utility>
+
+namespace {
+    constexpr uint64_t SEED = 1;
+    constexpr int BOARDS = 3000;
+
+    using Footprint = std::set<std::pair<int, int>>; // (x, y) of the piece cells
+
+    Footprint footprint(const Tetromino &t) {
+        Footprint cells;
+        const PieceShape &shape = shapeOf(t);
+
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                if (shape.rows[i] >> j & 1) cells.insert({ t.x + j, t.y + i });
+
+        return cells;
+    }
+
+    // up to 16 rows of random cells, dense enough for holes, overhangs and the odd full row
+    Board randomBoard(Random &rng) {
+        uint16_t rows[BOARD_HEIGHT];
+        int height = static_cast<int>(rng.below(16));
+
+        for (int y = 0; y < BOARD_HEIGHT; ++y) {
+            rows[y] = BOARD_EMPTY_ROW;
+            if (y < BOARD_HEIGHT - height) continue;
+
+            for (int x = 0; x < BOARD_WIDTH; ++x)
+                if (rng.below(100) < 55) rows[y] |= boardColumnBit(x);
+        }
+
+        Board board;
+        board.loadRows(rows);
+        return board;
+    }
+
+    // footprint -> shortest number of keys (hard drop included) that locks the piece there
+    std::map<Footprint, int> bruteForce(const Board &board, const Tetromino &start) {
+        auto key = [](const Tetromino &t) { return std::make_tuple(t.rotation, t.x, t.y); };
+
+        std::map<std::tuple<uint8_t, int8_t, int8_t>, int> distance{ { key(start), 0 } };
+        std::queue<Tetromino> queue;
+        queue.push(start);
+        std::map<Footprint, int> landings;
+
+        while (!queue.empty()) {
+            Tetromino t = queue.front();
+            queue.pop();
+            int d = distance[key(t)];
+
+            Tetromino dropped = t;
+            dropped.y = static_cast<int8_t>(dropped.y + board.dropDistance(t));
+            auto [it, inserted] = landings.try_emplace(footprint(dropped), d + 1);
+            if (!inserted && it->second > d + 1) it->second = d + 1;
+
+            Tetromino next[4] = { t, t, t, t };
+            --next[0].x;
+            ++next[1].x;
+            ++next[2].y;
+            bool rotated = rotateWithKicks(board, next[3]);
+
+            for (int k = 0; k < 4; ++k) {
+                if (k < 3 ? board.collides(next[k]) : !rotated) continue;
+                if (distance.try_emplace(key(next[k]), d + 1).second) queue.push(next[k]);
+            }
+        }
+
+        return landings;
+    }
+
+    // plays the keys with the game's moves; false if one of them is not a legal move
+    bool replay(const Board &board, Tetromino t, const int *keys, int count, Tetromino &end) {
+        for (int k = 0; k < count; ++k) {
+            Tetromino moved = t;
+
+            switch (keys[k]) {
+                case 'a': --moved.x; break;
+                case 'd': ++moved.x; break;
+                case 's': ++moved.y; break;
+                case 'w': if (!rotateWithKicks(board, moved)) return false; break;
+                case ' ': moved.y = static_cast<int8_t>(moved.y + board.dropDistance(moved)); break;
+                default: return false;
+            }
+
+            if (board.collides(moved)) return false;
+            t = moved;
+        }
+
+        end = t;
+        return true;
+    }
+
+    bool check(PlacementFinder &finder, const Board &board, const Tetromino &start, int index) {
+        std::map<Footprint, int> expected = bruteForce(board, start);
+        std::map<Footprint, int> found;
+
+        for (const Placement &p : finder.find(board, start)) {
+            if (!found.emplace(footprint(p.piece), p.inputs).second) {
+                std::printf("board %d: a footprint was reported twice\n", index);
+                return false;
+            }
+
+            int keys[PlacementFinder::MAX_STATES + 1];
+            int count = finder.path(p, keys);
+            Tetromino end;
+
+            if (count != p.inputs || !replay(board, start, keys, count, end) || end.x != p.piece.x || end.y != p.piece.y || end.rotation != p.piece.rotation) {
+                std::printf("board %d: the path does not lead to its placement\n", index);
+                return false;
+            }
+        }
+
+        if (found != expected) {
+            std::printf("board %d: %zu placements found, brute force has %zu (or the input counts differ)\n", index, found.size(), expected.size());
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main() {
+    Random rng(SEED);
+    PlacementFinder finder;
+    int checked = 0;
+
+    for (int i = 0; i < BOARDS; ++i) {
+        Board board = randomBoard(rng);
+        Tetromino start = createPiece(static_cast<uint8_t>(rng.below(TETROMINO_TYPES)));
+        start.x = BOARD_WIDTH / 2 - 2;
+        if (board.collides(start)) continue;
+
+        if (!check(finder, board, start, i)) return 1;
+        ++checked;
+    }
+
+    std::printf("%d boards match the brute-force search\n", checked);
+    return 0;
+}
@@ -0,0 +1,369 @@
+// Microbenchmarks for the core game kernels. Every benchmark runs long enough to be timed reliably,
+// is repeated a few times and reports the median ns/op. --json writes the results for later runs
+// to --compare against, which exits with 1 when something got slower than the allowed threshold.
+
+#include "../include/board.hpp"
+#include "../include/board_batch.hpp"
+#include "../include/game_state.hpp"
+#include "../include/modes.hpp"
+#include "../include/random.hpp"
+#include "../include/renderer.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // keeps the compiler from discarding a result or hoisting work out of the timed loop
+    template <typename T>
+    inline void keep(const T &value) {
+#if defined(_MSC_VER)
+        static volatile const void *sink;
+        sink = &value;
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    struct Options {
+        double minTimeMs = 50; // per repetition
+        int repetitions = 5;
+        std::string filter;
+        std::string jsonPath;
+        std::string comparePath;
+        double thresholdPercent = 10;
+    };
+
+    struct Result {
+        std::string name;
+        double nsPerOp = 0;
+        long long iterations = 0; // per repetition
+    };
+
+    class Suite {
+    public:
+        explicit Suite(const Options &o) : options(o) {}
+
+        // op(i) is one operation; i counts up so benchmarks can cycle through their inputs
+        template <typename Op>
+        void add(const std::string &name, Op op) {
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+            auto run = [&](long long n) {
+                auto start = Clock::now();
+                for (long long i = 0; i < n; ++i) op(i);
+                return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            };
+
+            // grow the iteration count until one repetition takes minTimeMs
+            long long n = 1;
+            double minNs = options.minTimeMs * 1e6;
+            for (double ns = run(n); ns < minNs; ns = run(n)) {
+                double factor = ns > 0 ? std::min(10.0, 1.2 * minNs / ns) : 10.0;
+                n = std::max(n + 1, static_cast<long long>(n * factor));
+            }
+
+            std::vector<double> samples;
+            for (int r = 0; r < options.repetitions; ++r) samples.push_back(run(n) / static_cast<double>(n));
+            std::sort(samples.begin(), samples.end());
+
+            Result result{ name, samples[samples.size() / 2], n };
+            std::printf("%-28s %10.1f ns/op %12lld iterations\n", result.name.c_str(), result.nsPerOp, result.iterations);
+            std::fflush(stdout);
+            results.push_back(result);
+        }
+
+        const std::vector<Result> &getResults() const { return results; }
+
+    private:
+        Options options;
+        std::vector<Result> results;
+    };
+
+    // Fixtures: an empty board, a stack up to mid-height and one a few rows below the top. Every
+    // stacked row has one or two holes, so no row is full unless a fixture makes it so.
+    Board stackedBoard(int height, int fullRows = 0) {
+        Random rng(0xB0A2D, static_cast<uint64_t>(height));
+        uint16_t rows[BOARD_HEIGHT];
+
+        for (int y = 0; y < BOARD_HEIGHT; ++y) {
+            rows[y] = BOARD_EMPTY_ROW;
+            if (y < BOARD_HEIGHT - height) continue;
+
+            rows[y] = BOARD_FULL_ROW;
+            if (y >= BOARD_HEIGHT - fullRows) continue;
+
+            rows[y] &= static_cast<uint16_t>(~boardColumnBit(static_cast<int>(rng.below(BOARD_WIDTH))));
+            if (rng.below(2)) rows[y] &= static_cast<uint16_t>(~boardColumnBit(static_cast<int>(rng.below(BOARD_WIDTH))));
+        }
+
+        Board board;
+        board.loadRows(rows);
+        return board;
+    }
+
+    struct Fixture {
+        const char *name;
+        Board board;
+    };
+
+    std::vector<Fixture> fixtures() {
+        return { { "empty", Board() }, { "half", stackedBoard(BOARD_HEIGHT / 2) }, { "top", stackedBoard(BOARD_HEIGHT - 3) } };
+    }
+
+    // 64 pieces of every type and rotation spread over the board, some of them into the stack
+    constexpr int PIECE_COUNT = 64;
+
+    std::vector<Tetromino> scatteredPieces() {
+        Random rng(0x91ECE5);
+        std::vector<Tetromino> pieces;
+
+        for (int i = 0; i < PIECE_COUNT; ++i) {
+            Tetromino t = createPiece(static_cast<uint8_t>(rng.below(TETROMINO_TYPES)));
+            t.rotation = static_cast<uint8_t>(rng.below(TETROMINO_ROTATIONS));
+            t.x = static_cast<int8_t>(rng.below(BOARD_WIDTH - 1));
+            t.y = static_cast<int8_t>(rng.below(BOARD_HEIGHT - 3));
+            pieces.push_back(t);
+        }
+
+        return pieces;
+    }
+
+    // One op is a key from a fixed pattern followed by a tick; a game that tops out is replaced.
+    void tickBenchmark(Suite &suite, const char *name, const Mode &mode) {
+        static constexpr int KEYS[] = { 'a', 0, 'w', 0, 'd', 'd', 0, 's', 0, 0, 'a', 0, 0, ' ', 0, 0 };
+
+        uint64_t seed = 1;
+        auto fresh = [&] {
+            auto state = std::make_unique<GameState>(seed++);
+            state->setMode(mode);
+            state->start();
+            return state;
+        };
+
+        std::unique_ptr<GameState> state = fresh();
+
+        suite.add(name, [&](long long i) {
+            int key = KEYS[i % std::size(KEYS)];
+            if (key) state->applyInput(key);
+            state->advanceTick();
+            keep(state->takeEvents());
+            if (state->isGameOver()) state = fresh();
+        });
+    }
+
+    void runAll(Suite &suite) {
+        std::vector<Tetromino> pieces = scatteredPieces();
+
+        for (const Fixture &f : fixtures()) {
+            std::string suffix = std::string("/") + f.name;
+            const Board &fixture = f.board;
+
+            suite.add("collides" + suffix, [&](long long i) { keep(fixture.collides(pieces[i % PIECE_COUNT])); });
+
+            // dropDistance expects a piece that fits, so it only gets the scattered pieces that do
+            std::vector<Tetromino> fitting;
+            for (const Tetromino &t : pieces) if (!fixture.collides(t)) fitting.push_back(t);
+            suite.add("dropDistance" + suffix, [&](long long i) { keep(fixture.dropDistance(fitting[i % fitting.size()])); });
+
+            // includes copying the fixture, which every lock needs to start from the same board
+            suite.add("lockPiece" + suffix, [&](long long i) {
+                Board board = fixture;
+                board.lockPiece(pieces[i % PIECE_COUNT]);
+                keep(board);
+            });
+
+            suite.add("rotateWithKicks" + suffix, [&](long long i) {
+                Tetromino t = pieces[i % PIECE_COUNT];
+                keep(rotateWithKicks(fixture, t));
+                keep(t);
+            });
+
+            Renderer renderer; // frames are composed but never presented
+            suite.add("draw" + suffix, [&](long long i) {
+                renderer.clear();
+                fixture.draw(renderer, pieces[i % PIECE_COUNT], 123456, 7, 999999, "1) Fill bottom hole (press 1)\n2) Skip current piece (press 2)");
+                keep(renderer);
+            });
+        }
+
+        for (int lines : { 0, 1, 4 }) {
+            Board fixture = stackedBoard(BOARD_HEIGHT / 2, lines);
+
+            suite.add("clearLines/" + std::to_string(lines), [&](long long) {
+                Board board = fixture;
+                keep(board.clearLines());
+                keep(board);
+            });
+        }
+
+        {
+            // every power-up unlocked, so the note has all four lines
+            GameState state(1);
+            state.setMode(FunMode({ { 0, 0, 0, 0 }, { 15, 15, 15, 30 } }));
+            state.start();
+            state.advanceTick();
+
+            const FunMode &mode = std::get<FunMode>(state.getMode());
+            suite.add("FunMode::getSideNote", [&](long long) { keep(mode.getSideNote()); });
+        }
+
+        tickBenchmark(suite, "tick/normal", NormalMode());
+        tickBenchmark(suite, "tick/fun", FunMode());
+        tickBenchmark(suite, "tick/mixed", MixedMode());
+
+        {
+            // every lane starts with a different piece and column at the top of the board, so the lanes
+            // land, clear and top out at different times
+            BoardBatch batch;
+            Tetromino spawn[BoardBatch::LANES];
+            for (int i = 0; i < BoardBatch::LANES; ++i) {
+                spawn[i] = createPiece(static_cast<uint8_t>(i % TETROMINO_TYPES));
+                spawn[i].x = static_cast<int8_t>(i % (BOARD_WIDTH - 3));
+            }
+            batch.spawnActive(spawn, BoardBatch::ALL_LANES);
+
+            // one op moves the pieces of all 16 lanes down a row; landed pieces lock and respawn
+            suite.add("BoardBatch::dropActive", [&](long long) {
+                uint32_t landed = batch.dropActive();
+                if (!landed) return;
+
+                batch.lockActive(landed);
+                batch.clearLines();
+
+                // the next piece of a lane is another type, rotation and column, so rows do fill up
+                for (uint32_t l = landed; l; l &= l - 1) {
+                    Tetromino &t = spawn[std::countr_zero(l)];
+                    t.type = static_cast<uint8_t>((t.type + 1) % TETROMINO_TYPES);
+                    t.rotation = static_cast<uint8_t>((t.rotation + 1) % TETROMINO_ROTATIONS);
+                    t.x = static_cast<int8_t>((t.x + 2) % (BOARD_WIDTH - 3));
+                }
+
+                if (uint32_t toppedOut = batch.spawnActive(spawn, landed)) {
+                    for (uint32_t l = toppedOut; l; l &= l - 1) batch.clearLane(std::countr_zero(l));
+                    batch.spawnActive(spawn, toppedOut);
+                }
+            });
+        }
+    }
+
+    bool writeJson(const std::string &path, const std::vector<Result> &results) {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        out << "{\n  \"kernel\": \"" << BoardBatch::kernelName() << "\",\n  \"benchmarks\": [\n";
+
+        char line[256];
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result &r = results[i];
+            std::snprintf(line, sizeof(line), "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"iterations\": %lld}%s\n", r.name.c_str(), r.nsPerOp, r.iterations, i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    // Reads the files writeJson produces (one benchmark per line); not a general JSON parser.
+    bool readJson(const std::string &path, std::map<std::string, double> &results) {
+        std::ifstream in(path);
+        if (!in) return false;
+
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t name = line.find("\"name\": \"");
+            size_t ns = line.find("\"ns_per_op\": ");
+            if (name == std::string::npos || ns == std::string::npos) continue;
+
+            name += 9;
+            size_t end = line.find('"', name);
+            if (end == std::string::npos) continue;
+
+            results[line.substr(name, end - name)] = std::strtod(line.c_str() + ns + 13, nullptr);
+        }
+
+        return true;
+    }
+
+    // Prints the change against a previous run; returns false if anything regressed past the threshold.
+    bool compare(const std::vector<Result> &results, const std::map<std::string, double> &baseline, double thresholdPercent) {
+        bool ok = true;
+        std::printf("\n%-28s %10s %10s %8s\n", "compared to baseline", "before", "after", "change");
+
+        for (const Result &r : results) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end() || it->second <= 0) continue;
+
+            double change = 100.0 * (r.nsPerOp - it->second) / it->second;
+            bool regressed = change > thresholdPercent;
+            ok = ok && !regressed;
+
+            std::printf("%-28s %10.1f %10.1f %+7.1f%%%s\n", r.name.c_str(), it->second, r.nsPerOp, change, regressed ? "  REGRESSION" : "");
+        }
+
+        return ok;
+    }
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: tetris_bench [options]\n"
+            "  --filter TEXT        only run benchmarks whose name contains TEXT\n"
+            "  --min-time MS        minimum duration of one repetition (50)\n"
+            "  --repetitions N      repetitions per benchmark; the median is reported (5)\n"
+            "  --json FILE          write the results as JSON\n"
+            "  --compare FILE       compare against a JSON file from an earlier run\n"
+            "  --threshold PCT      slowdown that counts as a regression for --compare (10)\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    Options o;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const char *option = argv[i];
+        const char *value = argv[i + 1];
+
+        if (std::strcmp(option, "--filter") == 0) o.filter = value;
+        else if (std::strcmp(option, "--min-time") == 0) o.minTimeMs = std::max(1.0, std::atof(value));
+        else if (std::strcmp(option, "--repetitions") == 0) o.repetitions = std::max(1, std::atoi(value));
+        else if (std::strcmp(option, "--json") == 0) o.jsonPath = value;
+        else if (std::strcmp(option, "--compare") == 0) o.comparePath = value;
+        else if (std::strcmp(option, "--threshold") == 0) o.thresholdPercent = std::atof(value);
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!o.comparePath.empty() && !readJson(o.comparePath, baseline)) {
+        std::fprintf(stderr, "cannot read %s\n", o.comparePath.c_str());
+        return 1;
+    }
+
+    Suite suite(o);
+    runAll(suite);
+
+    if (!o.jsonPath.empty() && !writeJson(o.jsonPath, suite.getResults())) {
+        std::fprintf(stderr, "cannot write %s\n", o.jsonPath.c_str());
+        return 1;
+    }
+
+    if (!o.comparePath.empty() && !compare(suite.getResults(), baseline, o.thresholdPercent)) return 1;
+    return 0;
+}
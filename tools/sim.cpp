@@ -0,0 +1,347 @@
+// Headless batch runner for balancing: plays many games with the AutoPlayer on every core and
+// prints aggregate statistics per mode configuration. Every configuration is played on the same
+// seeds, so differences between rows come from the parameters rather than from the pieces.
+
+#include "../include/autoplayer.hpp"
+#include "../include/game_state.hpp"
+#include "../include/modes.hpp"
+#include "../include/placement.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/transposition.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int MAX_LEVELS = 11; // lines per level are reported for levels 0-9 and 10+
+
+    struct Options {
+        int games = 200; // per configuration
+        unsigned threads = std::thread::hardware_concurrency();
+        uint64_t seed = 1;
+        int maxPieces = 2000; // games are cut off here; a good player may never top out
+        bool lookahead = false;
+        Randomizer randomizer = Randomizer::Uniform;
+
+        bool normal = true, fun = true, hard = true, mixed = true;
+        std::vector<double> funThresholdScales{ 0.5, 1.0, 2.0 };
+        std::vector<double> funCooldownScales{ 0.5, 1.0, 2.0 };
+        std::vector<int> hardChances{ 5, 10, 20 };
+        std::vector<int> hardMinScores{ 0, 500, 2000 };
+    };
+
+    enum class ModeKind { Normal, Fun, Hard, Mixed };
+
+    struct Config {
+        std::string label;
+        ModeKind kind = ModeKind::Normal;
+        FunModeConfig fun;
+        HardModeConfig hard;
+    };
+
+    struct GameResult {
+        int score = 0;
+        int lines = 0;
+        int pieces = 0;
+        int ticks = 0;
+        bool capped = false;
+        EffectCounts effects;
+        int linesPerLevel[MAX_LEVELS] = {};
+    };
+
+    uint64_t gameSeed(uint64_t base, size_t game) {
+        Random mix(base, game);
+        return mix.next();
+    }
+
+    Mode makeMode(const Config &c) {
+        switch (c.kind) {
+            case ModeKind::Fun: return FunMode(c.fun);
+            case ModeKind::Hard: return HardMode(c.hard);
+            case ModeKind::Mixed: return MixedMode(c.fun, c.hard);
+            default: return NormalMode();
+        }
+    }
+
+    // The player uses every power-up as soon as it is ready and otherwise places pieces with the AutoPlayer.
+    // It presses one key per tick, like a fast human, so pieces keep falling under the mode's gravity
+    // (and Hard-mode speed-ups) while they are moved into place, and a plan can fail halfway.
+    GameResult playGame(const Config &config, uint64_t seed, const Options &options, TranspositionCache &cache) {
+        GameState state(seed, options.randomizer);
+        state.setMode(makeMode(config));
+        AutoPlayer player({}, options.lookahead, &cache);
+
+        GameResult result;
+        int lastSpawn = -1;
+        int lines = 0, level = 0;
+
+        int keys[PlacementFinder::MAX_STATES + 2]; // the plan for one piece plus its hard drop
+        int queued = 0, pressed = 0;
+        int plannedFor = -1; // getPiecesSpawned() of the piece the queued keys move
+
+        auto account = [&] {
+            state.takeEvents();
+            result.linesPerLevel[std::min(level, MAX_LEVELS - 1)] += state.getLinesCleared() - lines;
+            lines = state.getLinesCleared();
+            level = state.getLevel();
+        };
+
+        state.start();
+
+        while (!state.isGameOver() && state.getPiecesSpawned() <= options.maxPieces) {
+            // power-ups are not piece moves, so they do not wait for their turn
+            if ((config.kind == ModeKind::Fun || config.kind == ModeKind::Mixed) && state.getPiecesSpawned() != lastSpawn) {
+                for (int key : { '1', '2', '3', '4' }) state.applyInput(key);
+                lastSpawn = state.getPiecesSpawned();
+            }
+
+            // gravity may have locked the piece before its plan was through; the rest is for a piece that is gone
+            if (state.getPiecesSpawned() != plannedFor) {
+                queued = pressed = 0;
+                plannedFor = state.getPiecesSpawned();
+            }
+
+            for (auto planned = player.update(state); !planned.empty(); planned = player.update(state))
+                for (int key : planned)
+                    if (queued < static_cast<int>(std::size(keys))) keys[queued++] = key;
+
+            if (pressed < queued) {
+                state.applyInput(keys[pressed++]);
+                account();
+            }
+
+            state.advanceTick();
+            account();
+        }
+
+        result.score = state.getScore();
+        result.lines = state.getLinesCleared();
+        result.pieces = state.getPiecesSpawned();
+        result.ticks = state.getTick();
+        result.capped = !state.isGameOver();
+        result.effects = state.getEffectCounts();
+        return result;
+    }
+
+    std::vector<Config> buildConfigs(const Options &o) {
+        std::vector<Config> configs;
+        char label[96];
+
+        if (o.normal) configs.push_back({ "normal", ModeKind::Normal, {}, {} });
+
+        if (o.fun) {
+            for (double ts : o.funThresholdScales) {
+                for (double cs : o.funCooldownScales) {
+                    Config c{ "", ModeKind::Fun, {}, {} };
+
+                    for (int i = 0; i < 4; ++i) {
+                        c.fun.pointsThreshold[i] = static_cast<int>(c.fun.pointsThreshold[i] * ts);
+                        c.fun.cooldown[i] = std::max(1, static_cast<int>(c.fun.cooldown[i] * cs));
+                    }
+
+                    std::snprintf(label, sizeof(label), "fun thr x%.2g cd x%.2g", ts, cs);
+                    c.label = label;
+                    configs.push_back(c);
+                }
+            }
+        }
+
+        if (o.hard) {
+            for (int chance : o.hardChances) {
+                for (int minScore : o.hardMinScores) {
+                    Config c{ "", ModeKind::Hard, {}, {} };
+                    c.hard.chancePercent = chance;
+                    c.hard.minScore = minScore;
+
+                    std::snprintf(label, sizeof(label), "hard %d%% from %d", chance, minScore);
+                    c.label = label;
+                    configs.push_back(c);
+                }
+            }
+        }
+
+        if (o.mixed) configs.push_back({ "mixed", ModeKind::Mixed, {}, {} });
+
+        return configs;
+    }
+
+    template <typename T>
+    std::vector<T> parseList(const char *s) {
+        std::vector<T> values;
+
+        while (*s) {
+            char *end;
+            values.push_back(static_cast<T>(std::strtod(s, &end)));
+            if (end == s) break;
+            s = (*end == ',') ? end + 1 : end;
+        }
+
+        return values;
+    }
+
+    void report(const Config &config, std::vector<GameResult> results) {
+        size_t n = results.size();
+        double pieces = 0, ticks = 0, lines = 0, capped = 0;
+        double fills = 0, skips = 0, slows = 0, deletes = 0, speedUps = 0;
+        double perLevel[MAX_LEVELS] = {};
+
+        for (const GameResult &r : results) {
+            pieces += r.pieces;
+            ticks += r.ticks;
+            lines += r.lines;
+            capped += r.capped;
+            fills += r.effects.holesFilled;
+            skips += r.effects.piecesSkipped;
+            slows += r.effects.slowsApplied;
+            deletes += r.effects.rowDeletes;
+            speedUps += r.effects.speedUps;
+            for (int l = 0; l < MAX_LEVELS; ++l) perLevel[l] += r.linesPerLevel[l];
+        }
+
+        std::sort(results.begin(), results.end(), [](const GameResult &a, const GameResult &b) { return a.score < b.score; });
+        auto percentile = [&](double p) { return results[std::min(n - 1, static_cast<size_t>(p * n))].score; };
+
+        double sum = 0;
+        for (const GameResult &r : results) sum += r.score;
+
+        std::printf("%-24s score mean %9.0f  p10 %8d  p50 %8d  p90 %8d  max %8d\n", config.label.c_str(), sum / n, percentile(0.1), percentile(0.5), percentile(0.9), results[n - 1].score);
+        std::printf("%-24s pieces %7.1f  ticks %8.1f  lines %7.1f  capped %5.1f%%\n", "", pieces / n, ticks / n, lines / n, 100.0 * capped / n);
+        std::printf("%-24s per game: fill %.2f  skip %.2f  slow %.2f  delete %.2f  speed-up %.2f\n", "", fills / n, skips / n, slows / n, deletes / n, speedUps / n);
+        std::printf("%-24s lines per level:", "");
+        for (int l = 0; l < MAX_LEVELS; ++l) std::printf(" %.1f", perLevel[l] / n);
+        std::printf("\n\n");
+    }
+
+    // Speed-ups only count if they change how games go. A Hard (or Mixed) configuration whose games
+    // all play exactly like those of its reference without speed-ups (Normal, or Fun with the same
+    // config) measures nothing, so it is flagged. Returns false if any configuration was flagged.
+    bool checkSpeedUpsMatter(const std::vector<Config> &configs, const std::vector<GameResult> &results, size_t games) {
+        auto reference = [&](const Config &c) -> int {
+            for (size_t r = 0; r < configs.size(); ++r) {
+                const Config &candidate = configs[r];
+
+                if (c.kind == ModeKind::Hard && candidate.kind == ModeKind::Normal) return static_cast<int>(r);
+                if (c.kind == ModeKind::Mixed && candidate.kind == ModeKind::Fun &&
+                    std::memcmp(&candidate.fun, &c.fun, sizeof(FunModeConfig)) == 0) return static_cast<int>(r);
+            }
+
+            return -1;
+        };
+
+        bool ok = true;
+
+        for (size_t c = 0; c < configs.size(); ++c) {
+            int r = reference(configs[c]);
+            if (r < 0) continue;
+
+            bool same = true;
+            long speedUps = 0;
+
+            for (size_t g = 0; g < games; ++g) {
+                const GameResult &a = results[c * games + g], &b = results[r * games + g];
+                speedUps += a.effects.speedUps;
+                same &= a.score == b.score && a.lines == b.lines && a.pieces == b.pieces && a.ticks == b.ticks;
+            }
+
+            if (same && speedUps > 0) {
+                std::printf("WARNING: %s played exactly like %s despite %ld speed-ups; its results do not measure them\n",
+                    configs[c].label.c_str(), configs[r].label.c_str(), speedUps);
+                ok = false;
+            }
+        }
+
+        return ok;
+    }
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: tetris_sim [options]\n"
+            "  --games N               games per configuration (200)\n"
+            "  --threads N             worker threads (all cores)\n"
+            "  --seed N                base seed; every configuration plays the same seeds (1)\n"
+            "  --max-pieces N          cut games off after N pieces (2000)\n"
+            "  --lookahead             let the player look at the next piece (plays much longer)\n"
+            "  --bag                   7-bag randomizer\n"
+            "  --modes LIST            any of normal,fun,hard,mixed (all)\n"
+            "  --fun-thresholds LIST   scales for the power-up point thresholds (0.5,1,2)\n"
+            "  --fun-cooldowns LIST    scales for the power-up cooldowns (0.5,1,2)\n"
+            "  --hard-chances LIST     speed-up chances in percent (5,10,20)\n"
+            "  --hard-min-scores LIST  scores from which speed-ups start (0,500,2000)\n"
+            "Hard and Mixed results that match Normal (or Fun) game for game despite speed-ups are flagged\n"
+            "and make the exit status 2.\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    Options o;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--lookahead") == 0) { o.lookahead = true; continue; }
+        if (std::strcmp(argv[i], "--bag") == 0) { o.randomizer = Randomizer::SevenBag; continue; }
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const char *option = argv[i];
+        const char *value = argv[++i];
+
+        if (std::strcmp(option, "--games") == 0) o.games = std::max(1, std::atoi(value));
+        else if (std::strcmp(option, "--threads") == 0) o.threads = static_cast<unsigned>(std::max(1, std::atoi(value)));
+        else if (std::strcmp(option, "--seed") == 0) o.seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(option, "--max-pieces") == 0) o.maxPieces = std::max(1, std::atoi(value));
+        else if (std::strcmp(option, "--modes") == 0) {
+            o.normal = std::strstr(value, "normal") != nullptr;
+            o.fun = std::strstr(value, "fun") != nullptr;
+            o.hard = std::strstr(value, "hard") != nullptr;
+            o.mixed = std::strstr(value, "mixed") != nullptr;
+        }
+        else if (std::strcmp(option, "--fun-thresholds") == 0) o.funThresholdScales = parseList<double>(value);
+        else if (std::strcmp(option, "--fun-cooldowns") == 0) o.funCooldownScales = parseList<double>(value);
+        else if (std::strcmp(option, "--hard-chances") == 0) o.hardChances = parseList<int>(value);
+        else if (std::strcmp(option, "--hard-min-scores") == 0) o.hardMinScores = parseList<int>(value);
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<Config> configs = buildConfigs(o);
+    if (configs.empty()) {
+        usage();
+        return 1;
+    }
+
+    size_t games = static_cast<size_t>(o.games);
+    std::vector<GameResult> results(configs.size() * games);
+
+    // games of different configurations on the same seed reach the same boards, so they share one cache
+    TranspositionCache cache(20);
+    WorkStealingPool pool(o.threads);
+
+    auto start = std::chrono::steady_clock::now();
+
+    pool.run(results.size(), [&](size_t index, unsigned) {
+        size_t config = index / games, game = index % games;
+        results[index] = playGame(configs[config], gameSeed(o.seed, game), o, cache);
+    });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    long long pieces = 0;
+    for (const GameResult &r : results) pieces += r.pieces;
+
+    for (size_t c = 0; c < configs.size(); ++c)
+        report(configs[c], std::vector<GameResult>(results.begin() + c * games, results.begin() + (c + 1) * games));
+
+    bool measurable = checkSpeedUpsMatter(configs, results, games);
+
+    std::printf("%zu games on %u threads in %.2f s: %.1f games/s, %.0f pieces/s\n", results.size(), pool.size(), elapsed.count(), results.size() / elapsed.count(), pieces / elapsed.count());
+    return measurable ? 0 : 2;
+}